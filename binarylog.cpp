@@ -0,0 +1,461 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "binarylog.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#if FMT_VERSION >= 80000
+#    include <fmt/args.h>
+#endif
+
+#include <QFile>
+#include <QtEndian>
+
+#include "fileutils.h"
+#include "log.h"
+
+namespace libtremotesf::impl::binarylog {
+    std::atomic_bool active{};
+
+    namespace {
+        struct FormatKey {
+            const char* format{};
+            const char* file{};
+            int line{};
+
+            auto operator<=>(const FormatKey&) const = default;
+        };
+
+        struct FormatDefinition {
+            uint32_t id{};
+            std::string_view format{};
+        };
+
+        std::string_view nullToEmpty(const char* string) {
+            return string ? std::string_view(string) : std::string_view();
+        }
+
+        void appendString(MessageBuffer& buffer, std::string_view string) {
+            buffer.appendBytes(string.data(), string.size());
+        }
+
+        void appendRecordHeader(MessageBuffer& buffer, RecordKind kind, QtMsgType type, size_t size) {
+            buffer.append(static_cast<uint32_t>(size));
+            buffer.append(static_cast<uint8_t>(kind));
+            buffer.append(static_cast<uint8_t>(type));
+            buffer.append(uint16_t{});
+        }
+
+        // Format ids of this thread's log sites, valid only while Writer is on the same file
+        struct CachedFormatId {
+            uint64_t fileGeneration{};
+            uint32_t id{};
+            std::string_view format{};
+        };
+
+        std::map<FormatKey, CachedFormatId>& threadFormatIds() {
+            thread_local std::map<FormatKey, CachedFormatId> ids{};
+            return ids;
+        }
+
+        MessageBuffer& threadRecordBuffer() {
+            thread_local MessageBuffer buffer{};
+            return buffer;
+        }
+
+        class Writer {
+        public:
+            ~Writer() { stop(); }
+
+            void start(const QString& filePath, qint64 fileSize, int maxFiles) {
+                const std::lock_guard lock(mMutex);
+                closeFile();
+                if (fileSize <= static_cast<qint64>(fileHeaderSize)) {
+                    throw std::invalid_argument("Binary log file size is too small");
+                }
+                mFilePath = filePath;
+                mFileSize = fileSize;
+                mMaxFiles = std::max(maxFiles, 1);
+                openFile();
+                active.store(true, std::memory_order_relaxed);
+            }
+
+            void stop() {
+                const std::lock_guard lock(mMutex);
+                active.store(false, std::memory_order_relaxed);
+                closeFile();
+            }
+
+            bool write(
+                QtMsgType type,
+                const QMessageLogContext& context,
+                std::string_view format,
+                const MessageBuffer& arguments
+            ) {
+                // Assemble record and look up cached format id before taking the lock,
+                // so that critical section is mostly a copy into mapping
+                using namespace std::chrono;
+                const auto timestamp = duration_cast<nanoseconds>(system_clock::now().time_since_epoch());
+                const auto messageSize =
+                    sizeof(RecordHeader) + sizeof(uint32_t) + sizeof(int64_t) + arguments.data().size();
+                const auto sizeWithDefinition = messageSize + definitionSize(context, format);
+                auto& record = threadRecordBuffer();
+                record.clear();
+                appendRecordHeader(record, RecordKind::Message, type, messageSize);
+                // Format id is filled in after record is copied
+                record.append(uint32_t{});
+                record.append(static_cast<int64_t>(timestamp.count()));
+                record.appendRaw(arguments.data());
+
+                const FormatKey key{format.data(), context.file, context.line};
+                auto& formatIds = threadFormatIds();
+                const auto cached = formatIds.find(key);
+
+                const std::lock_guard lock(mMutex);
+                if (!mMapping) {
+                    return false;
+                }
+                if (static_cast<qint64>(fileHeaderSize + sizeWithDefinition) > mFileSize) {
+                    // Message would not fit even into empty file
+                    return false;
+                }
+
+                std::optional<uint32_t> id{};
+                // Runtime format strings may reuse the same memory, so check contents too
+                if (cached != formatIds.end() && cached->second.fileGeneration == mFileGeneration &&
+                    cached->second.format == format) {
+                    id = cached->second.id;
+                } else if (const auto definition = findFormatDefinition(key, format); definition) {
+                    id = definition->id;
+                    formatIds.insert_or_assign(key, CachedFormatId{mFileGeneration, *id, format});
+                }
+                const auto requiredSize = id ? messageSize : sizeWithDefinition;
+                if (mPosition + static_cast<qint64>(requiredSize) > mFileSize) {
+                    if (!rotate()) {
+                        return false;
+                    }
+                    id = std::nullopt;
+                }
+                if (!id) {
+                    id = writeFormatDefinition(type, context, format).id;
+                    formatIds.insert_or_assign(key, CachedFormatId{mFileGeneration, *id, format});
+                }
+
+                const auto position = mPosition;
+                writeBytes(record.data());
+                qToLittleEndian(*id, mMapping + position + sizeof(RecordHeader));
+                return true;
+            }
+
+        private:
+            std::optional<FormatDefinition> findFormatDefinition(const FormatKey& key, std::string_view format) const {
+                const auto found = mFormatDefinitions.find(key);
+                if (found != mFormatDefinitions.end() && found->second.format == format) {
+                    return found->second;
+                }
+                return std::nullopt;
+            }
+
+            static size_t definitionSize(const QMessageLogContext& context, std::string_view format) {
+                // Header, id, line and four length-prefixed strings
+                return sizeof(RecordHeader) + sizeof(uint32_t) + sizeof(int32_t) + 4 * sizeof(uint32_t) +
+                       format.size() + nullToEmpty(context.category).size() + nullToEmpty(context.file).size() +
+                       nullToEmpty(context.function).size();
+            }
+
+            FormatDefinition
+            writeFormatDefinition(QtMsgType type, const QMessageLogContext& context, std::string_view format) {
+                const FormatDefinition definition{mNextFormatId, format};
+                ++mNextFormatId;
+                mFormatDefinitions.insert_or_assign(FormatKey{format.data(), context.file, context.line}, definition);
+
+                mDefinitionBuffer.clear();
+                const auto size = definitionSize(context, format);
+                appendRecordHeader(mDefinitionBuffer, RecordKind::FormatDefinition, type, size);
+                mDefinitionBuffer.append(definition.id);
+                mDefinitionBuffer.append(static_cast<int32_t>(context.line));
+                appendString(mDefinitionBuffer, format);
+                appendString(mDefinitionBuffer, nullToEmpty(context.category));
+                appendString(mDefinitionBuffer, nullToEmpty(context.file));
+                appendString(mDefinitionBuffer, nullToEmpty(context.function));
+                writeBytes(mDefinitionBuffer.data());
+                return definition;
+            }
+
+            void writeValue(uint32_t value) {
+                qToLittleEndian(value, mMapping + mPosition);
+                mPosition += static_cast<qint64>(sizeof(value));
+            }
+
+            void writeBytes(std::span<const std::byte> bytes) {
+                std::memcpy(mMapping + mPosition, bytes.data(), bytes.size());
+                mPosition += static_cast<qint64>(bytes.size());
+            }
+
+            void openFile() {
+                mFile = std::make_unique<QFile>(mFilePath);
+                libtremotesf::openFile(*mFile, QIODevice::ReadWrite | QIODevice::Truncate);
+                if (!mFile->resize(mFileSize)) {
+                    throw QFileError(fmt::format("Failed to resize binary log file {}", mFilePath));
+                }
+                mMapping = mFile->map(0, mFileSize);
+                if (!mMapping) {
+                    throw QFileError(fmt::format("Failed to map binary log file {}", mFilePath));
+                }
+                mPosition = 0;
+                writeBytes(std::as_bytes(std::span(magic)));
+                writeValue(version);
+                writeValue(uint32_t{});
+                mFormatDefinitions.clear();
+                mNextFormatId = 0;
+                ++mFileGeneration;
+            }
+
+            void closeFile() {
+                if (!mFile) {
+                    return;
+                }
+                if (mMapping) {
+                    mFile->unmap(mMapping);
+                    mMapping = nullptr;
+                    // Drop zero-filled tail
+                    mFile->resize(mPosition);
+                }
+                mFile->close();
+                mFile.reset();
+            }
+
+            bool rotate() {
+                closeFile();
+                const auto rotatedPath = [&](int index) { return QString("%1.%2").arg(mFilePath).arg(index); };
+                if (mMaxFiles > 1) {
+                    QFile::remove(rotatedPath(mMaxFiles - 1));
+                    for (int i = mMaxFiles - 2; i >= 1; --i) {
+                        QFile::rename(rotatedPath(i), rotatedPath(i + 1));
+                    }
+                    QFile::rename(mFilePath, rotatedPath(1));
+                }
+                try {
+                    openFile();
+                } catch (const QFileError& e) {
+                    closeFile();
+                    active.store(false, std::memory_order_relaxed);
+                    logWarningWithException(e, "Failed to rotate binary log, falling back to text log");
+                    return false;
+                }
+                return true;
+            }
+
+            std::mutex mMutex{};
+
+            QString mFilePath{};
+            qint64 mFileSize{};
+            int mMaxFiles{};
+
+            std::unique_ptr<QFile> mFile{};
+            uchar* mMapping{};
+            qint64 mPosition{};
+
+            std::map<FormatKey, FormatDefinition> mFormatDefinitions{};
+            uint32_t mNextFormatId{};
+            // Incremented on each opened file, invalidates format ids cached by threads
+            uint64_t mFileGeneration{};
+            MessageBuffer mDefinitionBuffer{};
+        };
+
+        Writer& writer() {
+            static Writer instance{};
+            return instance;
+        }
+
+        class Reader {
+        public:
+            explicit Reader(std::span<const std::byte> data) : mData(data) {}
+
+            bool atEnd() const { return mOffset >= mData.size(); }
+            size_t offset() const { return mOffset; }
+
+            template<typename T>
+                requires std::integral<T> || std::same_as<T, double>
+            T read() {
+                if constexpr (std::same_as<T, double>) {
+                    return std::bit_cast<double>(read<uint64_t>());
+                } else {
+                    return qFromLittleEndian<T>(take(sizeof(T)).data());
+                }
+            }
+
+            RecordHeader readRecordHeader() {
+                RecordHeader header{};
+                header.size = read<uint32_t>();
+                header.kind = static_cast<RecordKind>(read<uint8_t>());
+                header.messageType = read<uint8_t>();
+                header.reserved = read<uint16_t>();
+                return header;
+            }
+
+            std::span<const std::byte> take(size_t size) {
+                if (size > mData.size() - mOffset) {
+                    throw std::runtime_error("Unexpected end of binary log data");
+                }
+                const auto bytes = mData.subspan(mOffset, size);
+                mOffset += size;
+                return bytes;
+            }
+
+            std::string readString() {
+                const auto bytes = take(read<uint32_t>());
+                return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            }
+
+        private:
+            std::span<const std::byte> mData;
+            size_t mOffset{};
+        };
+
+        struct DecodedFormatDefinition {
+            std::string format{};
+            std::string category{};
+            std::string file{};
+            int line{};
+            std::string function{};
+        };
+
+        std::string decodeMessage(Reader& reader, const DecodedFormatDefinition& definition) {
+            fmt::dynamic_format_arg_store<fmt::format_context> arguments{};
+            const auto count = reader.read<uint8_t>();
+            for (uint8_t i = 0; i < count; ++i) {
+                switch (static_cast<ArgumentTag>(reader.read<uint8_t>())) {
+                case ArgumentTag::Int64:
+                    arguments.push_back(reader.read<int64_t>());
+                    break;
+                case ArgumentTag::UInt64:
+                    arguments.push_back(reader.read<uint64_t>());
+                    break;
+                case ArgumentTag::Double:
+                    arguments.push_back(reader.read<double>());
+                    break;
+                case ArgumentTag::Bool:
+                    arguments.push_back(reader.read<uint8_t>() != 0);
+                    break;
+                case ArgumentTag::Utf8String:
+                    arguments.push_back(reader.readString());
+                    break;
+                case ArgumentTag::Utf16String: {
+                    const auto bytes = reader.take(reader.read<uint32_t>());
+                    std::u16string utf16(bytes.size() / sizeof(char16_t), u'\0');
+                    qFromLittleEndian<quint16>(bytes.data(), static_cast<qsizetype>(utf16.size()), utf16.data());
+                    arguments.push_back(
+                        QString::fromUtf16(utf16.data(), static_cast<QString::size_type>(utf16.size())).toStdString()
+                    );
+                    break;
+                }
+                case ArgumentTag::Latin1String: {
+                    const auto bytes = reader.take(reader.read<uint32_t>());
+                    const auto latin1 = reinterpret_cast<const char*>(bytes.data());
+                    const auto size = static_cast<QString::size_type>(bytes.size());
+                    arguments.push_back(QString::fromLatin1(latin1, size).toStdString());
+                    break;
+                }
+                default:
+                    throw std::runtime_error(fmt::format("Unknown argument tag at offset {}", reader.offset() - 1));
+                }
+            }
+            try {
+                return fmt::vformat(definition.format, arguments);
+            } catch (const fmt::format_error& e) {
+                return fmt::format("<failed to format '{}': {}>", definition.format, e.what());
+            }
+        }
+    }
+
+    MessageBuffer& threadMessageBuffer() {
+        thread_local MessageBuffer buffer{};
+        return buffer;
+    }
+
+    bool writeMessageRecord(
+        QtMsgType type, const QMessageLogContext& context, std::string_view format, const MessageBuffer& arguments
+    ) {
+        return writer().write(type, context, format, arguments);
+    }
+
+    std::vector<DecodedMessage> decode(std::span<const std::byte> data) {
+        Reader reader(data);
+        if (data.size() < fileHeaderSize ||
+            std::memcmp(reader.take(magic.size()).data(), magic.data(), magic.size()) != 0) {
+            throw std::runtime_error("Not a binary log file");
+        }
+        // Newer versions only add argument tags, so older files are readable too
+        if (const auto fileVersion = reader.read<uint32_t>(); fileVersion == 0 || fileVersion > version) {
+            throw std::runtime_error(fmt::format("Unsupported binary log version {}", fileVersion));
+        }
+        reader.read<uint32_t>();
+
+        std::map<uint32_t, DecodedFormatDefinition> definitions{};
+        std::vector<DecodedMessage> messages{};
+        while (data.size() - reader.offset() >= sizeof(RecordHeader)) {
+            const auto header = reader.readRecordHeader();
+            if (header.size == 0) {
+                break;
+            }
+            if (header.size < sizeof(RecordHeader)) {
+                throw std::runtime_error(fmt::format("Invalid record size at offset {}", reader.offset()));
+            }
+            Reader recordReader(reader.take(header.size - sizeof(RecordHeader)));
+            switch (header.kind) {
+            case RecordKind::FormatDefinition: {
+                const auto id = recordReader.read<uint32_t>();
+                DecodedFormatDefinition definition{};
+                definition.line = recordReader.read<int32_t>();
+                definition.format = recordReader.readString();
+                definition.category = recordReader.readString();
+                definition.file = recordReader.readString();
+                definition.function = recordReader.readString();
+                definitions.insert_or_assign(id, std::move(definition));
+                break;
+            }
+            case RecordKind::Message: {
+                const auto id = recordReader.read<uint32_t>();
+                const auto found = definitions.find(id);
+                if (found == definitions.end()) {
+                    throw std::runtime_error(fmt::format("Unknown format string id {}", id));
+                }
+                const auto& definition = found->second;
+                DecodedMessage message{};
+                message.timestamp = recordReader.read<int64_t>();
+                message.type = static_cast<QtMsgType>(header.messageType);
+                message.category = definition.category;
+                message.file = definition.file;
+                message.line = definition.line;
+                message.function = definition.function;
+                message.message = decodeMessage(recordReader, definition);
+                messages.push_back(std::move(message));
+                break;
+            }
+            default:
+                // Skip unknown records for forward compatibility
+                break;
+            }
+        }
+        return messages;
+    }
+}
+
+namespace libtremotesf {
+    void startBinaryLog(const QString& filePath, qint64 fileSize, int maxFiles) {
+        impl::binarylog::writer().start(filePath, fileSize, maxFiles);
+    }
+
+    void stopBinaryLog() { impl::binarylog::writer().stop(); }
+}
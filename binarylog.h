@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_BINARYLOG_H
+#define LIBTREMOTESF_BINARYLOG_H
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <QLatin1String>
+#include <QMessageLogContext>
+#include <QString>
+#include <QStringView>
+#include <QtEndian>
+
+#include <fmt/core.h>
+#if FMT_VERSION < 80000
+#    include <fmt/format.h>
+#endif
+
+namespace libtremotesf {
+    /**
+     * Optional binary logging backend
+     * When started, log statements are recorded as format string id and raw arguments
+     * into memory mapped rotating files instead of being formatted and printed.
+     * Formatting is deferred to offline decoder (libtremotesf_log_decoder)
+     *
+     * Throws QFileError if file can't be created or mapped
+     */
+    void startBinaryLog(const QString& filePath, qint64 fileSize = 64 * 1024 * 1024, int maxFiles = 4);
+    void stopBinaryLog();
+
+    namespace impl {
+        /**
+         * Binary log file layout (all integers are little-endian):
+         * - File header: magic (8 bytes), version (uint32), reserved (uint32)
+         * - Records, each starting with RecordHeader
+         * - Zero-filled remainder of file (record with size 0 terminates reading)
+         */
+        namespace binarylog {
+            inline constexpr std::string_view magic = "TRLOGBIN";
+            // Version 2 added Latin1String argument tag
+            inline constexpr uint32_t version = 2;
+            inline constexpr size_t fileHeaderSize = 16;
+
+            enum class RecordKind : uint8_t { FormatDefinition = 1, Message = 2 };
+            enum class ArgumentTag : uint8_t { Int64 = 1, UInt64, Double, Bool, Utf8String, Utf16String, Latin1String };
+
+            struct RecordHeader {
+                uint32_t size;
+                RecordKind kind;
+                uint8_t messageType;
+                uint16_t reserved;
+            };
+            static_assert(sizeof(RecordHeader) == 8);
+
+            /**
+             * Record buffer for a single message
+             * Arguments are appended as tag followed by little-endian value
+             */
+            class MessageBuffer {
+            public:
+                void clear() { mData.clear(); }
+                std::span<const std::byte> data() const { return mData; }
+
+                void appendTag(ArgumentTag tag) { append(static_cast<uint8_t>(tag)); }
+
+                template<typename T>
+                    requires std::integral<T> || std::same_as<T, double>
+                void append(T value) {
+                    if constexpr (std::same_as<T, double>) {
+                        append(std::bit_cast<uint64_t>(value));
+                    } else {
+                        qToLittleEndian(value, grow(sizeof(T)));
+                    }
+                }
+
+                void appendBytes(const void* data, size_t size) {
+                    append(static_cast<uint32_t>(size));
+                    appendRaw(std::span(static_cast<const std::byte*>(data), size));
+                }
+
+                void appendUtf16(const QChar* data, size_t size) {
+                    append(static_cast<uint32_t>(size * sizeof(char16_t)));
+                    if (size != 0) {
+                        qToLittleEndian<quint16>(data, static_cast<qsizetype>(size), grow(size * sizeof(char16_t)));
+                    }
+                }
+
+                void appendRaw(std::span<const std::byte> bytes) {
+                    if (!bytes.empty()) {
+                        std::memcpy(grow(bytes.size()), bytes.data(), bytes.size());
+                    }
+                }
+
+            private:
+                std::byte* grow(size_t size) {
+                    const auto offset = mData.size();
+                    mData.resize(offset + size);
+                    return mData.data() + offset;
+                }
+
+                std::vector<std::byte> mData{};
+            };
+
+            template<typename T>
+            concept IsRawCharacter = std::same_as<T, char> || std::same_as<T, char16_t> || std::same_as<T, char32_t> ||
+                                     std::same_as<T, wchar_t>;
+
+            template<typename T>
+            void appendArgument(MessageBuffer& buffer, const T& value) {
+                using U = std::remove_cvref_t<T>;
+                if constexpr (std::same_as<U, bool>) {
+                    buffer.appendTag(ArgumentTag::Bool);
+                    buffer.append(static_cast<uint8_t>(value));
+                } else if constexpr (IsRawCharacter<U>) {
+                    const std::string formatted = fmt::format("{}", value);
+                    buffer.appendTag(ArgumentTag::Utf8String);
+                    buffer.appendBytes(formatted.data(), formatted.size());
+                } else if constexpr (std::signed_integral<U>) {
+                    buffer.appendTag(ArgumentTag::Int64);
+                    buffer.append(static_cast<int64_t>(value));
+                } else if constexpr (std::unsigned_integral<U>) {
+                    buffer.appendTag(ArgumentTag::UInt64);
+                    buffer.append(static_cast<uint64_t>(value));
+                } else if constexpr (std::floating_point<U>) {
+                    buffer.appendTag(ArgumentTag::Double);
+                    buffer.append(static_cast<double>(value));
+                } else if constexpr (std::same_as<U, QString> || std::same_as<U, QStringView>) {
+                    buffer.appendTag(ArgumentTag::Utf16String);
+                    buffer.appendUtf16(value.data(), static_cast<size_t>(value.size()));
+                } else if constexpr (std::same_as<U, QLatin1String>) {
+                    buffer.appendTag(ArgumentTag::Latin1String);
+                    buffer.appendBytes(value.data(), static_cast<size_t>(value.size()));
+                } else if constexpr (std::convertible_to<const U&, std::string_view>) {
+                    const auto view = static_cast<std::string_view>(value);
+                    buffer.appendTag(ArgumentTag::Utf8String);
+                    buffer.appendBytes(view.data(), view.size());
+                } else {
+                    // Types without raw representation are formatted eagerly
+                    const std::string formatted = fmt::format("{}", value);
+                    buffer.appendTag(ArgumentTag::Utf8String);
+                    buffer.appendBytes(formatted.data(), formatted.size());
+                }
+            }
+
+            extern std::atomic_bool active;
+
+            inline bool isActive() { return active.load(std::memory_order_relaxed); }
+
+            MessageBuffer& threadMessageBuffer();
+
+            /**
+             * Writes message record. Returns false if binary log is not active
+             * (in which case message should be logged as text)
+             */
+            bool writeMessageRecord(
+                QtMsgType type,
+                const QMessageLogContext& context,
+                std::string_view format,
+                const MessageBuffer& arguments
+            );
+
+            template<typename... Args>
+            bool writeMessage(
+                QtMsgType type, const QMessageLogContext& context, std::string_view format, const Args&... args
+            ) {
+                auto& buffer = threadMessageBuffer();
+                buffer.clear();
+                buffer.append(static_cast<uint8_t>(sizeof...(Args)));
+                (appendArgument(buffer, args), ...);
+                return writeMessageRecord(type, context, format, buffer);
+            }
+
+            struct DecodedMessage {
+                int64_t timestamp{}; // nanoseconds since Unix epoch
+                QtMsgType type{};
+                std::string category{};
+                std::string file{};
+                int line{};
+                std::string function{};
+                std::string message{};
+            };
+
+            /**
+             * Decodes all messages in binary log file contents
+             * Throws std::runtime_error if data is malformed
+             */
+            std::vector<DecodedMessage> decode(std::span<const std::byte> data);
+        }
+    }
+}
+
+#endif // LIBTREMOTESF_BINARYLOG_H
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <span>
+#include <stdexcept>
+
+#include <QDateTime>
+#include <QString>
+
+#include "binarylog.h"
+#include "fileutils.h"
+#include "log.h"
+
+using namespace libtremotesf;
+using namespace libtremotesf::impl::binarylog;
+
+namespace {
+    std::string_view messageTypeString(QtMsgType type) {
+        switch (type) {
+        case QtDebugMsg:
+            return "debug";
+        case QtInfoMsg:
+            return "info";
+        case QtWarningMsg:
+            return "warning";
+        case QtCriticalMsg:
+            return "critical";
+        case QtFatalMsg:
+            return "fatal";
+        }
+        return "unknown";
+    }
+
+    void decodeFile(const QString& path) {
+        const QByteArray data = readFile(path);
+        const auto messages = decode(std::as_bytes(std::span(data.data(), static_cast<size_t>(data.size()))));
+        for (const auto& message : messages) {
+            const auto dateTime = QDateTime::fromMSecsSinceEpoch(message.timestamp / 1000000, Qt::UTC);
+            printlnStdout(
+                "{} {} {}: {} ({}:{})",
+                dateTime.toString(Qt::ISODateWithMs),
+                messageTypeString(message.type),
+                message.category,
+                message.message,
+                message.file,
+                message.line
+            );
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fmt::print(
+            stderr,
+            "Usage: {} FILE...\n"
+            "Decode binary log files written by libtremotesf and print them to stdout.\n"
+            "Rotated files should be passed from oldest to newest (e.g. log.2 log.1 log)\n",
+            argv[0]
+        );
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        const auto path = QString::fromLocal8Bit(argv[i]);
+        try {
+            decodeFile(path);
+        } catch (const std::exception& e) {
+            fmt::print(stderr, "Failed to decode {}: {}\n", path, e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <array>
+#include <span>
+#include <string>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "binarylog.h"
+#include "fileutils.h"
+#include "literals.h"
+#include "log.h"
+
+using namespace libtremotesf;
+using namespace libtremotesf::impl::binarylog;
+
+namespace {
+    std::vector<DecodedMessage> decodeFile(const QString& path) {
+        const QByteArray data = readFile(path);
+        return decode(std::as_bytes(std::span(data.data(), static_cast<size_t>(data.size()))));
+    }
+}
+
+class BinaryLogTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundTrip() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("log"_l1);
+
+        startBinaryLog(path, 64 * 1024, 2);
+        logInfo("foo {} {} {} {}", 42, -1.5, true, QString("bar"));
+        logCWarning(jsonLog, "baz");
+        logInfo("{} {}", "qux", std::string_view("quux"));
+        stopBinaryLog();
+
+        const auto messages = decodeFile(path);
+        QCOMPARE(messages.size(), static_cast<size_t>(3));
+
+        QCOMPARE(messages[0].message, std::string("foo 42 -1.5 true bar"));
+        QCOMPARE(messages[0].type, QtInfoMsg);
+        QCOMPARE(messages[0].category, std::string("default"));
+
+        QCOMPARE(messages[1].message, std::string("baz"));
+        QCOMPARE(messages[1].type, QtWarningMsg);
+        QCOMPARE(messages[1].category, std::string("libtremotesf.json"));
+
+        QCOMPARE(messages[2].message, std::string("qux quux"));
+    }
+
+    void nonAsciiStrings() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("log"_l1);
+
+        startBinaryLog(path, 64 * 1024, 2);
+        logInfo("{} {}", QLatin1String("caf\xe9"), QString::fromUtf8("\xd0\xb6\xf0\x9f\x98\x80"));
+        stopBinaryLog();
+
+        const auto messages = decodeFile(path);
+        QCOMPARE(messages.size(), static_cast<size_t>(1));
+        QCOMPARE(messages[0].message, std::string("caf\xc3\xa9 \xd0\xb6\xf0\x9f\x98\x80"));
+    }
+
+    void rotation() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("log"_l1);
+
+        startBinaryLog(path, 4096, 2);
+        for (int i = 0; i < 1000; ++i) {
+            logInfo("message {}", i);
+        }
+        stopBinaryLog();
+
+        QVERIFY(QFile::exists(path));
+        QVERIFY(QFile::exists(path + ".1"_l1));
+        QVERIFY(!QFile::exists(path + ".2"_l1));
+
+        const auto rotated = decodeFile(path + ".1"_l1);
+        const auto current = decodeFile(path);
+        QVERIFY(!rotated.empty());
+        QVERIFY(!current.empty());
+        QCOMPARE(current.back().message, std::string("message 999"));
+        // Each file is self-contained and messages are continuous across rotation
+        QCOMPARE(rotated.back().message, fmt::format("message {}", 999 - static_cast<int>(current.size())));
+    }
+
+    void malformed() {
+        const std::array<std::byte, 4> garbage{};
+        bool thrown = false;
+        try {
+            [[maybe_unused]] const auto messages = decode(garbage);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        QVERIFY(thrown);
+    }
+};
+
+QTEST_MAIN(BinaryLogTest)
+
+#include "binarylog_test.moc"
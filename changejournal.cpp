@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "changejournal.h"
+
+#include <map>
+#include <set>
+
+namespace libtremotesf::impl {
+    void TorrentsChangeJournal::setCapacity(size_t capacity, bool torrentsListEmpty) {
+        if (mCapacity == 0 && capacity != 0) {
+            if (!torrentsListEmpty || mVersion != 0) {
+                ++mVersion;
+            }
+            mFirstVersion = mVersion;
+        }
+        mCapacity = capacity;
+        while (mEntries.size() > mCapacity) {
+            mEntries.pop_front();
+        }
+    }
+
+    void TorrentsChangeJournal::record(
+        std::vector<std::pair<int, TorrentData::UpdateKeySet>>&& changed,
+        std::vector<int>&& added,
+        std::vector<int>&& removed
+    ) {
+        if (mCapacity == 0 || (changed.empty() && added.empty() && removed.empty())) {
+            return;
+        }
+        ++mVersion;
+        if (mEntries.size() == mCapacity) {
+            mEntries.pop_front();
+        }
+        mEntries.push_back(Entry{
+            .version = mVersion,
+            .changed = std::move(changed),
+            .added = std::move(added),
+            .removed = std::move(removed)});
+    }
+
+    TorrentsDelta TorrentsChangeJournal::changesSince(quint64 version) const {
+        TorrentsDelta delta{.version = mVersion};
+        if (version == mVersion) {
+            return delta;
+        }
+        if (version > mVersion || version < mFirstVersion || mEntries.empty() ||
+            mEntries.front().version > version + 1) {
+            delta.fullResyncNeeded = true;
+            return delta;
+        }
+
+        std::map<int, TorrentData::UpdateKeySet> changed{};
+        std::set<int> added{};
+        std::set<int> removed{};
+        for (const auto& entry : mEntries) {
+            if (entry.version <= version) continue;
+            for (const int id : entry.removed) {
+                changed.erase(id);
+                // Torrent that was added and then removed is of no interest to consumer
+                if (added.erase(id) == 0) {
+                    removed.insert(id);
+                }
+            }
+            for (const int id : entry.added) {
+                changed.erase(id);
+                added.insert(id);
+            }
+            for (const auto& [id, keys] : entry.changed) {
+                // Consumer will read added torrents in full anyway
+                if (!added.contains(id)) {
+                    changed[id] |= keys;
+                }
+            }
+        }
+
+        delta.changed.assign(changed.begin(), changed.end());
+        delta.added.assign(added.begin(), added.end());
+        delta.removed.assign(removed.begin(), removed.end());
+        return delta;
+    }
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_CHANGEJOURNAL_H
+#define LIBTREMOTESF_CHANGEJOURNAL_H
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "torrent.h"
+
+namespace libtremotesf {
+    /**
+     * Changes of torrents list between two versions, see Rpc::torrentsChangesSince()
+     * Torrents are identified by their ids. All vectors are sorted by id
+     */
+    struct TorrentsDelta {
+        // Version that consumer should pass next time
+        quint64 version{};
+        // Journal doesn't go back far enough, consumer should reread whole list
+        bool fullResyncNeeded{};
+
+        std::vector<std::pair<int, TorrentData::UpdateKeySet>> changed{};
+        // Same id may be both removed and added (e.g. after reconnection), removals should be applied first
+        std::vector<int> added{};
+        std::vector<int> removed{};
+    };
+
+    namespace impl {
+        /**
+         * Bounded, sequence-numbered history of changes of torrents list
+         * Not thread-safe
+         */
+        class TorrentsChangeJournal {
+        public:
+            size_t capacity() const { return mCapacity; }
+            /**
+             * 0 disables journal
+             * Changes made before journal was enabled are not known, so when it is enabled with non-empty
+             * torrents list (or re-enabled), consumers with older versions are told to do full resync
+             */
+            void setCapacity(size_t capacity, bool torrentsListEmpty = true);
+
+            quint64 version() const { return mVersion; }
+
+            void record(
+                std::vector<std::pair<int, TorrentData::UpdateKeySet>>&& changed,
+                std::vector<int>&& added,
+                std::vector<int>&& removed
+            );
+
+            TorrentsDelta changesSince(quint64 version) const;
+
+        private:
+            struct Entry {
+                quint64 version{};
+                std::vector<std::pair<int, TorrentData::UpdateKeySet>> changed{};
+                std::vector<int> added{};
+                std::vector<int> removed{};
+            };
+
+            std::deque<Entry> mEntries{};
+            size_t mCapacity{};
+            quint64 mVersion{};
+            // Journal is complete starting from this version
+            quint64 mFirstVersion{};
+        };
+    }
+}
+
+#endif // LIBTREMOTESF_CHANGEJOURNAL_H
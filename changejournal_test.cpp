@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+
+#include "changejournal.h"
+
+using namespace libtremotesf;
+using namespace libtremotesf::impl;
+
+namespace {
+    TorrentData::UpdateKeySet keys(std::initializer_list<TorrentData::UpdateKey> keys) {
+        TorrentData::UpdateKeySet set{};
+        for (const auto key : keys) {
+            set.set(static_cast<size_t>(key));
+        }
+        return set;
+    }
+}
+
+class ChangeJournalTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void disabledByDefault() {
+        TorrentsChangeJournal journal{};
+        journal.record({}, {1, 2}, {});
+        QCOMPARE(journal.version(), quint64{0});
+        const auto delta = journal.changesSince(0);
+        QVERIFY(!delta.fullResyncNeeded);
+        QVERIFY(delta.added.empty());
+    }
+
+    void emptyUpdatesAreNotRecorded() {
+        TorrentsChangeJournal journal{};
+        journal.setCapacity(4);
+        journal.record({}, {}, {});
+        QCOMPARE(journal.version(), quint64{0});
+    }
+
+    void mergesChanges() {
+        TorrentsChangeJournal journal{};
+        journal.setCapacity(8);
+        journal.record({}, {1, 2, 3}, {});
+        const auto afterAdding = journal.version();
+
+        journal.record({{1, keys({TorrentData::UpdateKey::Name})}}, {4}, {});
+        journal.record(
+            {{1, keys({TorrentData::UpdateKey::Status})}, {4, keys({TorrentData::UpdateKey::Name})}},
+            {},
+            {2}
+        );
+        journal.record({}, {5}, {3});
+        journal.record({}, {}, {5});
+
+        const auto delta = journal.changesSince(afterAdding);
+        QCOMPARE(delta.version, journal.version());
+        QVERIFY(!delta.fullResyncNeeded);
+        QCOMPARE(delta.changed.size(), size_t{1});
+        QCOMPARE(delta.changed[0].first, 1);
+        QVERIFY(delta.changed[0].second == keys({TorrentData::UpdateKey::Name, TorrentData::UpdateKey::Status}));
+        QCOMPARE(delta.added, std::vector<int>{4});
+        QCOMPARE(delta.removed, (std::vector<int>{2, 3}));
+
+        const auto full = journal.changesSince(0);
+        // Torrents that were added and then removed are not reported
+        QCOMPARE(full.added, (std::vector<int>{1, 4}));
+        QVERIFY(full.removed.empty());
+        QVERIFY(full.changed.empty());
+
+        QVERIFY(journal.changesSince(journal.version()).added.empty());
+    }
+
+    void truncatedJournalNeedsResync() {
+        TorrentsChangeJournal journal{};
+        journal.setCapacity(2);
+        journal.record({}, {1}, {});
+        journal.record({}, {2}, {});
+        journal.record({}, {3}, {});
+        QVERIFY(journal.changesSince(0).fullResyncNeeded);
+        QVERIFY(!journal.changesSince(1).fullResyncNeeded);
+        QCOMPARE(journal.changesSince(1).added, (std::vector<int>{2, 3}));
+        QVERIFY(journal.changesSince(journal.version() + 1).fullResyncNeeded);
+    }
+
+    void enablingWithExistingTorrentsNeedsResync() {
+        TorrentsChangeJournal journal{};
+        journal.setCapacity(4, false);
+        const auto initial = journal.changesSince(0);
+        QVERIFY(initial.fullResyncNeeded);
+        QCOMPARE(initial.version, quint64{1});
+
+        journal.record({}, {1}, {});
+        const auto delta = journal.changesSince(initial.version);
+        QVERIFY(!delta.fullResyncNeeded);
+        QCOMPARE(delta.added, std::vector<int>{1});
+    }
+
+    void reenablingNeedsResync() {
+        TorrentsChangeJournal journal{};
+        journal.setCapacity(4);
+        journal.record({}, {1}, {});
+        const auto version = journal.version();
+        journal.setCapacity(0);
+        journal.record({}, {2}, {});
+        journal.setCapacity(4);
+        QVERIFY(journal.changesSince(version).fullResyncNeeded);
+        QVERIFY(!journal.changesSince(journal.version()).fullResyncNeeded);
+    }
+};
+
+QTEST_MAIN(ChangeJournalTest)
+
+#include "changejournal_test.moc"
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "infohash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libtremotesf {
+    namespace {
+        std::optional<uint8_t> fromHexDigit(QChar ch) {
+            const auto code = ch.unicode();
+            if (code >= '0' && code <= '9') return static_cast<uint8_t>(code - '0');
+            if (code >= 'a' && code <= 'f') return static_cast<uint8_t>(code - 'a' + 10);
+            if (code >= 'A' && code <= 'F') return static_cast<uint8_t>(code - 'A' + 10);
+            return std::nullopt;
+        }
+
+        constexpr std::array hexDigits{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+    }
+
+    std::optional<InfoHash> InfoHash::fromHexString(QStringView hex) {
+        const auto size = static_cast<size_t>(hex.size()) / 2;
+        if (static_cast<size_t>(hex.size()) % 2 != 0 || (size != v1Size && size != v2Size)) {
+            return std::nullopt;
+        }
+        InfoHash hash{};
+        for (size_t i = 0; i < size; ++i) {
+            const auto high = fromHexDigit(hex[static_cast<qsizetype>(i * 2)]);
+            const auto low = fromHexDigit(hex[static_cast<qsizetype>(i * 2 + 1)]);
+            if (!high.has_value() || !low.has_value()) {
+                return std::nullopt;
+            }
+            hash.mBytes[i] = static_cast<std::byte>((*high << 4) | *low);
+        }
+        hash.mSize = static_cast<uint8_t>(size);
+        return hash;
+    }
+
+    QString InfoHash::toString() const {
+        QString string(static_cast<int>(mSize * 2), Qt::Uninitialized);
+        auto* out = string.data();
+        for (const auto byte : bytes()) {
+            const auto value = std::to_integer<uint8_t>(byte);
+            *out++ = QLatin1Char(hexDigits[value >> 4]);
+            *out++ = QLatin1Char(hexDigits[value & 0x0f]);
+        }
+        return string;
+    }
+}
+
+size_t std::hash<libtremotesf::InfoHash>::operator()(const libtremotesf::InfoHash& hash) const noexcept {
+    // Hash bytes are already uniformly distributed
+    size_t value{};
+    const auto bytes = hash.bytes();
+    std::memcpy(&value, bytes.data(), std::min(sizeof(value), bytes.size()));
+    return value;
+}
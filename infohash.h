@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_INFOHASH_H
+#define LIBTREMOTESF_INFOHASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+
+#include <QString>
+#include <QStringView>
+
+namespace libtremotesf {
+    /**
+     * Binary info hash of a torrent, either SHA-1 (BitTorrent v1) or SHA-256 (BitTorrent v2)
+     * Bytes past the size of hash are always zero so that comparison doesn't need to look at size
+     */
+    class InfoHash {
+    public:
+        static constexpr size_t v1Size = 20;
+        static constexpr size_t v2Size = 32;
+
+        InfoHash() = default;
+
+        /**
+         * Parses hexadecimal string of 40 or 64 characters, in any case
+         */
+        static std::optional<InfoHash> fromHexString(QStringView hex);
+
+        bool isEmpty() const { return mSize == 0; }
+        size_t size() const { return mSize; }
+        std::span<const std::byte> bytes() const { return std::span(mBytes).first(mSize); }
+
+        /**
+         * Returns lowercase hexadecimal string, as Transmission does
+         */
+        QString toString() const;
+
+        bool operator==(const InfoHash& other) const = default;
+
+    private:
+        alignas(16) std::array<std::byte, v2Size> mBytes{};
+        uint8_t mSize{};
+    };
+}
+
+template<>
+struct std::hash<libtremotesf::InfoHash> {
+    size_t operator()(const libtremotesf::InfoHash& hash) const noexcept;
+};
+
+#endif // LIBTREMOTESF_INFOHASH_H
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <unordered_set>
+
+#include <QTest>
+
+#include "infohash.h"
+#include "literals.h"
+
+using namespace libtremotesf;
+
+class InfoHashTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parseV1() {
+        const auto hash = InfoHash::fromHexString("0123456789abcdef0123456789ABCDEF01234567"_l1);
+        QVERIFY(hash.has_value());
+        QCOMPARE(hash->size(), InfoHash::v1Size);
+        QCOMPARE(hash->toString(), "0123456789abcdef0123456789abcdef01234567"_l1);
+    }
+
+    void parseV2() {
+        const QString hex = "d8dd32ac93357c368556af3ac1d95c9d76bd0dff6fa9833ecdac3d53134efabb"_l1;
+        const auto hash = InfoHash::fromHexString(hex);
+        QVERIFY(hash.has_value());
+        QCOMPARE(hash->size(), InfoHash::v2Size);
+        QCOMPARE(hash->toString(), hex);
+    }
+
+    void parseInvalid() {
+        QVERIFY(!InfoHash::fromHexString(QString()).has_value());
+        QVERIFY(!InfoHash::fromHexString("0123456789abcdef"_l1).has_value());
+        QVERIFY(!InfoHash::fromHexString("0123456789abcdef0123456789abcdef0123456"_l1).has_value());
+        QVERIFY(!InfoHash::fromHexString("0123456789abcdef0123456789abcdef0123456g"_l1).has_value());
+    }
+
+    void compareAndHash() {
+        const auto first = InfoHash::fromHexString("0123456789abcdef0123456789abcdef01234567"_l1);
+        const auto sameAsFirst = InfoHash::fromHexString("0123456789ABCDEF0123456789ABCDEF01234567"_l1);
+        const auto second = InfoHash::fromHexString("1123456789abcdef0123456789abcdef01234567"_l1);
+        QVERIFY(*first == *sameAsFirst);
+        QVERIFY(*first != *second);
+        QVERIFY(*first != InfoHash{});
+
+        const std::unordered_set<InfoHash> set{*first, *second};
+        QVERIFY(set.contains(*sameAsFirst));
+        QCOMPARE(set.size(), size_t{2});
+    }
+};
+
+QTEST_MAIN(InfoHashTest)
+
+#include "infohash_test.moc"
@@ -13,10 +13,12 @@
 #include <stdexcept>
 #include <type_traits>
 
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonValue>
 
 #include "log.h"
+#include "stdutils.h"
 
 SPECIALIZE_FORMATTER_FOR_QDEBUG(QJsonValue)
 
@@ -44,13 +46,25 @@ namespace libtremotesf::impl {
             const auto jsonValue = [&] {
                 if constexpr (std::same_as<JsonConstantT, int>) {
                     if (!value.isDouble()) {
-                        logWarning("JSON field with key {} and value {} is not a number", key, value);
+                        logCWarningDeduplicated(
+                            jsonLog,
+                            QString(key),
+                            "JSON field with key {} and value {} is not a number",
+                            key,
+                            value
+                        );
                         return std::optional<int>{};
                     }
                     return std::optional(value.toInt());
                 } else if constexpr (std::same_as<JsonConstantT, QLatin1String>) {
                     if (!value.isString()) {
-                        logWarning("JSON field with key {} and value {} is not a string", key, value);
+                        logCWarningDeduplicated(
+                            jsonLog,
+                            QString(key),
+                            "JSON field with key {} and value {} is not a string",
+                            key,
+                            value
+                        );
                         return std::optional<QString>{};
                     }
                     return std::optional(value.toString());
@@ -63,7 +77,13 @@ namespace libtremotesf::impl {
                 return mapping.jsonValue == jsonValue;
             });
             if (found == mappings.end()) {
-                logWarning("JSON field with key {} has unknown value {}", key, value);
+                logCWarningDeduplicated(
+                    jsonLog,
+                    unknownValueDeduplicationKey(key, *jsonValue),
+                    "JSON field with key {} has unknown value {}",
+                    key,
+                    value
+                );
                 return {};
             }
             return found->enumValue;
@@ -80,6 +100,14 @@ namespace libtremotesf::impl {
         }
 
     private:
+        static QString unknownValueDeduplicationKey(QLatin1String key, int value) {
+            return QString(key) + QLatin1Char('=') + QString::number(value);
+        }
+
+        static QString unknownValueDeduplicationKey(QLatin1String key, const QString& value) {
+            return QString(key) + QLatin1Char('=') + value;
+        }
+
         std::array<EnumMapping<EnumConstantT, JsonConstantT>, EnumCount> mappings{};
     };
 
@@ -97,20 +125,26 @@ namespace libtremotesf::impl {
 #endif
     }
 
-    inline void updateDateTime(QDateTime& dateTime, const QJsonValue& value, bool& changed) {
-        const auto newDateTime = toInt64(value);
-        if (newDateTime > 0) {
-            if (!dateTime.isValid() || newDateTime != dateTime.toSecsSinceEpoch()) {
-                dateTime.setSecsSinceEpoch(newDateTime);
-                changed = true;
-            }
+    /**
+     * Transmission uses 0 for unknown dates, and so do we
+     */
+    inline void updateDateTime(qint64& secsSinceEpoch, const QJsonValue& value, bool& changed) {
+        const auto newSecsSinceEpoch = toInt64(value);
+        if (newSecsSinceEpoch > 0) {
+            setChanged(secsSinceEpoch, newSecsSinceEpoch, changed);
         } else {
-            if (!dateTime.isNull()) {
-                dateTime.setDate({});
-                dateTime.setTime({});
-                changed = true;
-            }
+            setChanged(secsSinceEpoch, qint64{}, changed);
+        }
+    }
+
+    /**
+     * Returns null QDateTime if secsSinceEpoch is 0
+     */
+    inline QDateTime dateTimeFromSecsSinceEpoch(qint64 secsSinceEpoch) {
+        if (secsSinceEpoch == 0) {
+            return QDateTime({}, {}, Qt::UTC);
         }
+        return QDateTime::fromSecsSinceEpoch(secsSinceEpoch, Qt::UTC);
     }
 }
 
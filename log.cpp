@@ -4,11 +4,20 @@
 
 #include "log.h"
 
+#include <vector>
+
 #ifdef Q_OS_WIN
 #    include <guiddef.h>
 #    include <winrt/base.h>
 #endif
 
+namespace libtremotesf {
+    Q_LOGGING_CATEGORY(rpcLog, "libtremotesf.rpc")
+    Q_LOGGING_CATEGORY(requestsLog, "libtremotesf.requests")
+    Q_LOGGING_CATEGORY(torrentsLog, "libtremotesf.torrents")
+    Q_LOGGING_CATEGORY(jsonLog, "libtremotesf.json")
+}
+
 namespace libtremotesf::impl {
     void QMessageLoggerDelegate::log(const QString& string) const {
         // We use internal qt_message_output() function here because there are only two methods
@@ -16,9 +25,95 @@ namespace libtremotesf::impl {
         // when we are doing formatting on our own:
         // 1. QDebug marshalls everything through QTextStream
         // 2. QMessageLogger::<>(const char*, ...) overloads perform QString::vasprintf() formatting
+        if (binarylog::isActive() && binarylog::writeMessage(type, context, singleArgumentFormatString, string)) {
+            return;
+        }
         qt_message_output(type, context, string);
     }
 
+    namespace {
+        struct DeduplicatedLogSites {
+            std::mutex mutex{};
+            std::vector<DeduplicatedLogSite*> sites{};
+        };
+
+        // Constructed before first site, so outlives static sites
+        DeduplicatedLogSites& deduplicatedLogSites() {
+            static DeduplicatedLogSites sites{};
+            return sites;
+        }
+    }
+
+    DeduplicatedLogSite::DeduplicatedLogSite(std::chrono::steady_clock::duration summaryInterval)
+        : mSummaryInterval(summaryInterval) {
+        auto& registry = deduplicatedLogSites();
+        const std::lock_guard lock(registry.mutex);
+        registry.sites.push_back(this);
+    }
+
+    DeduplicatedLogSite::~DeduplicatedLogSite() {
+        auto& registry = deduplicatedLogSites();
+        const std::lock_guard lock(registry.mutex);
+        std::erase(registry.sites, this);
+    }
+
+    bool DeduplicatedLogSite::check(const QString& key, const QMessageLoggerDelegate& logger) {
+        const std::lock_guard lock(mMutex);
+
+        bool shouldLog{};
+        if (auto found = mSuppressedCounts.find(key); found != mSuppressedCounts.end()) {
+            ++(found->second);
+            mHasSuppressed = true;
+        } else if (mSuppressedCounts.size() < maximumKeys) {
+            mSuppressedCounts.emplace(key, 0);
+            shouldLog = true;
+        } else {
+            ++mSuppressedOverflowCount;
+            mHasSuppressed = true;
+        }
+
+        if (mHasSuppressed) {
+            const auto& context = logger.context;
+            mLoggerContext = LoggerContext{
+                .type = logger.type,
+                .file = context.file,
+                .line = context.line,
+                .function = context.function,
+                .category = context.category
+            };
+            if ((std::chrono::steady_clock::now() - mLastSummaryTime) >= mSummaryInterval) {
+                logSummary(logger);
+            }
+        }
+
+        return shouldLog;
+    }
+
+    void DeduplicatedLogSite::flush() {
+        const std::lock_guard lock(mMutex);
+        if (mHasSuppressed && mLoggerContext.has_value()) {
+            const auto& context = *mLoggerContext;
+            logSummary(
+                QMessageLoggerDelegate(context.type, context.file, context.line, context.function, context.category)
+            );
+        }
+    }
+
+    void DeduplicatedLogSite::logSummary(const QMessageLoggerDelegate& logger) {
+        for (auto& [suppressedKey, count] : mSuppressedCounts) {
+            if (count != 0) {
+                logger.log("Suppressed {} repeated messages for key '{}'", count, suppressedKey);
+                count = 0;
+            }
+        }
+        if (mSuppressedOverflowCount != 0) {
+            logger.log("Suppressed {} messages for other keys", mSuppressedOverflowCount);
+            mSuppressedOverflowCount = 0;
+        }
+        mHasSuppressed = false;
+        mLastSummaryTime = std::chrono::steady_clock::now();
+    }
+
     template<IsException E, bool PrintCausedBy>
     void QMessageLoggerDelegate::logExceptionRecursivelyImpl(const E& e) const {
         if constexpr (PrintCausedBy) {
@@ -56,3 +151,13 @@ namespace libtremotesf::impl {
     QMessageLoggerDelegate::logExceptionRecursivelyImpl<winrt::hresult_error, false>(const winrt::hresult_error&) const;
 #endif
 }
+
+namespace libtremotesf {
+    void flushDeduplicatedLogs() {
+        auto& registry = impl::deduplicatedLogSites();
+        const std::lock_guard lock(registry.mutex);
+        for (auto* site : registry.sites) {
+            site->flush();
+        }
+    }
+}
@@ -5,9 +5,14 @@
 #ifndef LIBTREMOTESF_LOG_H
 #define LIBTREMOTESF_LOG_H
 
+#include <chrono>
 #include <concepts>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <type_traits>
 
+#include <QLoggingCategory>
 #include <QMessageLogger>
 #include <QString>
 #include <fmt/core.h>
@@ -17,6 +22,7 @@
 #    include <winrt/base.h>
 #endif
 
+#include "binarylog.h"
 #include "formatters.h"
 
 #if FMT_VERSION < 80000
@@ -35,8 +41,47 @@
 #    define ALWAYS_INLINE inline
 #endif
 
+/**
+ * Minimum log level that is compiled in, 0 = debug, 1 = info, 2 = warning
+ * Log statements below this level are discarded at compile time
+ */
+#ifndef LIBTREMOTESF_MINIMUM_LOG_LEVEL
+#    define LIBTREMOTESF_MINIMUM_LOG_LEVEL 0
+#endif
+
 namespace libtremotesf {
+    Q_DECLARE_LOGGING_CATEGORY(rpcLog)
+    Q_DECLARE_LOGGING_CATEGORY(requestsLog)
+    Q_DECLARE_LOGGING_CATEGORY(torrentsLog)
+    Q_DECLARE_LOGGING_CATEGORY(jsonLog)
+
     namespace impl {
+        constexpr int logLevel(QtMsgType type) {
+            switch (type) {
+            case QtDebugMsg:
+                return 0;
+            case QtInfoMsg:
+                return 1;
+            case QtWarningMsg:
+            case QtCriticalMsg:
+            case QtFatalMsg:
+                return 2;
+            }
+            return 2;
+        }
+
+        constexpr bool isLogLevelCompiledIn(QtMsgType type) {
+            return logLevel(type) >= LIBTREMOTESF_MINIMUM_LOG_LEVEL;
+        }
+
+        /**
+         * Checks whether messages of given type are enabled for default category
+         */
+        inline bool isLogTypeEnabled(QtMsgType type) {
+            const auto category = QLoggingCategory::defaultCategory();
+            return !category || category->isEnabled(type);
+        }
+
         template<typename T>
         concept IsException = std::derived_from<std::remove_reference_t<T>, std::exception>
 #ifdef Q_OS_WIN
@@ -52,11 +97,21 @@ namespace libtremotesf {
 #endif
             ;
 
+        template<typename FormatString>
+        ALWAYS_INLINE std::string_view toStdStringView(const FormatString& format) {
+            const fmt::string_view view = format;
+            return {view.data(), view.size()};
+        }
+
         struct QMessageLoggerDelegate {
             constexpr explicit QMessageLoggerDelegate(
-                QtMsgType type, const char* fileName, int lineNumber, const char* functionName
+                QtMsgType type,
+                const char* fileName,
+                int lineNumber,
+                const char* functionName,
+                const char* categoryName = "default"
             )
-                : type(type), context(fileName, lineNumber, functionName, "default") {}
+                : type(type), context(fileName, lineNumber, functionName, categoryName) {}
 
             /**
              * Actual log function
@@ -96,6 +151,9 @@ namespace libtremotesf {
             template<typename... Args>
                 requires(sizeof...(Args) != 0)
             ALWAYS_INLINE void log(FORMAT_STRING fmt, Args&&... args) const {
+                if (binarylog::isActive() && binarylog::writeMessage(type, context, toStdStringView(fmt), args...)) {
+                    return;
+                }
                 log(fmt::format(fmt, std::forward<Args>(args)...));
             }
 
@@ -163,9 +221,67 @@ namespace libtremotesf {
             const;
 #endif
 
+        /**
+         * State of deduplicated log statement
+         * Message is logged only on first occurrence of each key,
+         * subsequent occurrences are counted and reported in a summary at most once per summaryInterval
+         */
+        class DeduplicatedLogSite {
+        public:
+            static constexpr size_t maximumKeys = 256;
+
+            /**
+             * Site is registered so that it is flushed by flushDeduplicatedLogs()
+             */
+            explicit DeduplicatedLogSite(std::chrono::steady_clock::duration summaryInterval = std::chrono::minutes(1));
+            /**
+             * Doesn't log anything since static sites are destroyed after logging may already be torn down
+             */
+            ~DeduplicatedLogSite();
+            Q_DISABLE_COPY_MOVE(DeduplicatedLogSite)
+
+            /**
+             * Returns true if message with this key should be logged
+             * If summary of suppressed messages is due it is logged with logger before returning
+             */
+            bool check(const QString& key, const QMessageLoggerDelegate& logger);
+
+            /**
+             * Logs summary of suppressed messages now, with context of last suppressed message
+             * Summary is otherwise logged only when site is hit again, see flushDeduplicatedLogs()
+             */
+            void flush();
+
+        private:
+            // QMessageLogContext is not copyable
+            struct LoggerContext {
+                QtMsgType type{};
+                const char* file{};
+                int line{};
+                const char* function{};
+                const char* category{};
+            };
+
+            void logSummary(const QMessageLoggerDelegate& logger);
+
+            std::mutex mMutex{};
+            std::optional<LoggerContext> mLoggerContext{};
+            std::chrono::steady_clock::duration mSummaryInterval;
+            std::chrono::steady_clock::time_point mLastSummaryTime{std::chrono::steady_clock::now()};
+            std::map<QString, size_t, std::less<>> mSuppressedCounts{};
+            size_t mSuppressedOverflowCount{};
+            bool mHasSuppressed{};
+        };
+
         inline constexpr auto printlnFormatString = "{}\n";
     }
 
+    /**
+     * Logs summaries of suppressed messages of all deduplicated log statements that were not reported yet
+     * Should be called by application before shutdown so that trailing suppressed messages are not lost
+     */
+    void flushDeduplicatedLogs();
+
     template<typename T>
     void printlnStdout(const T& value) {
         fmt::print(stdout, impl::printlnFormatString, value);
@@ -184,11 +300,67 @@ namespace tremotesf {
 
 #define QMLD(type) \
     libtremotesf::impl::QMessageLoggerDelegate(type, QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC)
-#define logDebug(...)                QMLD(QtDebugMsg).log(__VA_ARGS__)
-#define logDebugWithException(...)   QMLD(QtDebugMsg).logWithException(__VA_ARGS__)
-#define logInfo(...)                 QMLD(QtInfoMsg).log(__VA_ARGS__)
-#define logInfoWithException(...)    QMLD(QtInfoMsg).logWithException(__VA_ARGS__)
-#define logWarning(...)              QMLD(QtWarningMsg).log(__VA_ARGS__)
-#define logWarningWithException(...) QMLD(QtWarningMsg).logWithException(__VA_ARGS__)
+#define QMLDC(category, type)                  \
+    libtremotesf::impl::QMessageLoggerDelegate( \
+        type,                                   \
+        QT_MESSAGELOG_FILE,                     \
+        QT_MESSAGELOG_LINE,                     \
+        QT_MESSAGELOG_FUNC,                     \
+        category().categoryName()               \
+    )
+
+/**
+ * Level checks are performed before arguments are evaluated and formatted,
+ * so disabled log statement costs only a branch (or nothing if it is below LIBTREMOTESF_MINIMUM_LOG_LEVEL)
+ */
+#define LOG_IMPL(type, function, ...)                                       \
+    do {                                                                    \
+        if constexpr (libtremotesf::impl::isLogLevelCompiledIn(type)) {     \
+            if (libtremotesf::impl::isLogTypeEnabled(type)) {               \
+                QMLD(type).function(__VA_ARGS__);                           \
+            }                                                               \
+        }                                                                   \
+    } while (false)
+#define LOG_CATEGORY_IMPL(category, type, function, ...)                    \
+    do {                                                                    \
+        if constexpr (libtremotesf::impl::isLogLevelCompiledIn(type)) {     \
+            if (category().isEnabled(type)) {                               \
+                QMLDC(category, type).function(__VA_ARGS__);                \
+            }                                                               \
+        }                                                                   \
+    } while (false)
+
+#define LOG_DEDUPLICATED_IMPL(category, type, key, ...)                     \
+    do {                                                                    \
+        if constexpr (libtremotesf::impl::isLogLevelCompiledIn(type)) {     \
+            if (category().isEnabled(type)) {                               \
+                static libtremotesf::impl::DeduplicatedLogSite logSite{};   \
+                const auto logger = QMLDC(category, type);                  \
+                if (logSite.check(key, logger)) {                           \
+                    logger.log(__VA_ARGS__);                                \
+                }                                                           \
+            }                                                               \
+        }                                                                   \
+    } while (false)
+
+#define logDebug(...)                LOG_IMPL(QtDebugMsg, log, __VA_ARGS__)
+#define logDebugWithException(...)   LOG_IMPL(QtDebugMsg, logWithException, __VA_ARGS__)
+#define logInfo(...)                 LOG_IMPL(QtInfoMsg, log, __VA_ARGS__)
+#define logInfoWithException(...)    LOG_IMPL(QtInfoMsg, logWithException, __VA_ARGS__)
+#define logWarning(...)              LOG_IMPL(QtWarningMsg, log, __VA_ARGS__)
+#define logWarningWithException(...) LOG_IMPL(QtWarningMsg, logWithException, __VA_ARGS__)
+
+#define logCDebug(category, ...)   LOG_CATEGORY_IMPL(category, QtDebugMsg, log, __VA_ARGS__)
+#define logCInfo(category, ...)    LOG_CATEGORY_IMPL(category, QtInfoMsg, log, __VA_ARGS__)
+#define logCWarning(category, ...) LOG_CATEGORY_IMPL(category, QtWarningMsg, log, __VA_ARGS__)
+#define logCWarningWithException(category, ...) \
+    LOG_CATEGORY_IMPL(category, QtWarningMsg, logWithException, __VA_ARGS__)
+
+/**
+ * Logs warning only once for each distinct key at this call site,
+ * for use in loops where the same problem may repeat thousands of times
+ */
+#define logCWarningDeduplicated(category, key, ...) \
+    LOG_DEDUPLICATED_IMPL(category, QtWarningMsg, key, __VA_ARGS__)
 
 #endif // LIBTREMOTESF_LOG_H
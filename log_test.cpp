@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <QJsonObject>
+#include <QLoggingCategory>
 #include <QObject>
 #include <QStringList>
 #include <QTest>
@@ -328,6 +329,81 @@ private slots:
         }
     }
 
+    void categoryEnabled() {
+        int evaluated = 0;
+        logCInfo(rpcLog, "{}", ++evaluated);
+        logCWarning(rpcLog, "{}", ++evaluated);
+        QCOMPARE(evaluated, 2);
+    }
+
+    void categoryDisabledDoesNotEvaluateArguments() {
+        QLoggingCategory::setFilterRules("libtremotesf.json.debug=false\nlibtremotesf.json.info=false"_l1);
+        int evaluated = 0;
+        logCDebug(jsonLog, "{}", ++evaluated);
+        logCInfo(jsonLog, "{}", ++evaluated);
+        QCOMPARE(evaluated, 0);
+        logCWarning(jsonLog, "{}", ++evaluated);
+        QCOMPARE(evaluated, 1);
+        QLoggingCategory::setFilterRules({});
+    }
+
+    void defaultCategoryDisabledDoesNotEvaluateArguments() {
+        QLoggingCategory::setFilterRules("default.debug=false"_l1);
+        int evaluated = 0;
+        logDebug("{}", ++evaluated);
+        QCOMPARE(evaluated, 0);
+        QLoggingCategory::setFilterRules({});
+    }
+
+    void deduplicatedLogsOncePerKey() {
+        int evaluated = 0;
+        for (int i = 0; i < 3; ++i) {
+            logCWarningDeduplicated(jsonLog, "foo"_l1, "{}", ++evaluated);
+            logCWarningDeduplicated(jsonLog, "bar"_l1, "{}", ++evaluated);
+        }
+        QCOMPARE(evaluated, 2);
+    }
+
+    void deduplicatedLogSite() {
+        impl::DeduplicatedLogSite site(std::chrono::steady_clock::duration::zero());
+        const auto logger = QMLDC(jsonLog, QtWarningMsg);
+        QVERIFY(site.check("foo"_l1, logger));
+        QVERIFY(!site.check("foo"_l1, logger));
+        QVERIFY(site.check("bar"_l1, logger));
+        QVERIFY(!site.check("bar"_l1, logger));
+        QVERIFY(!site.check("foo"_l1, logger));
+    }
+
+    void deduplicatedLogSiteFlushesTrailingSuppressions() {
+        impl::DeduplicatedLogSite site(std::chrono::hours(1));
+        const auto logger = QMLDC(jsonLog, QtWarningMsg);
+        QVERIFY(site.check("foo"_l1, logger));
+        QVERIFY(!site.check("foo"_l1, logger));
+        QVERIFY(!site.check("foo"_l1, logger));
+        QTest::ignoreMessage(QtWarningMsg, "Suppressed 2 repeated messages for key 'foo'");
+        site.flush();
+        // Nothing left to report
+        site.flush();
+    }
+
+    void flushDeduplicatedLogsFlushesAllSites() {
+        impl::DeduplicatedLogSite site(std::chrono::hours(1));
+        const auto logger = QMLDC(jsonLog, QtWarningMsg);
+        QVERIFY(site.check("foo"_l1, logger));
+        QVERIFY(!site.check("foo"_l1, logger));
+        QTest::ignoreMessage(QtWarningMsg, "Suppressed 1 repeated messages for key 'foo'");
+        flushDeduplicatedLogs();
+    }
+
+    void deduplicatedLogSiteMaximumKeys() {
+        impl::DeduplicatedLogSite site{};
+        const auto logger = QMLDC(jsonLog, QtWarningMsg);
+        for (size_t i = 0; i < impl::DeduplicatedLogSite::maximumKeys; ++i) {
+            QVERIFY(site.check(QString::number(i), logger));
+        }
+        QVERIFY(!site.check("foo"_l1, logger));
+    }
+
 #ifdef Q_OS_WIN
     void warningHresultError() {
         winrt::hresult_error e(E_ACCESSDENIED);
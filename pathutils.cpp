@@ -3,10 +3,9 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <stdexcept>
-#include <QRegularExpression>
 
 #include "pathutils.h"
-#include "literals.h"
+#include "stringpool.h"
 
 namespace libtremotesf {
     // We can't use QDir::to/fromNativeSeparators because it checks for current OS,
@@ -15,13 +14,18 @@ namespace libtremotesf {
     namespace {
         constexpr auto windowsSeparatorChar = '\\';
         constexpr auto unixSeparatorChar = '/';
-        constexpr auto unixSeparatorString = "/"_l1;
 
         enum class PathType { Unix, WindowsAbsoluteDOSFilePath, WindowsUNCOrDOSDevicePath };
 
+        bool isAsciiLetter(QChar ch) {
+            const auto code = ch.unicode();
+            return (code >= 'A' && code <= 'Z') || (code >= 'a' && code <= 'z');
+        }
+
         bool isWindowsUNCOrDOSDevicePath(QStringView path) {
-            static const QRegularExpression regex(R"(^(?:\\|//).*$)"_l1);
-            return regex.match(path).hasMatch();
+            if (path.isEmpty()) return false;
+            if (path[0] == windowsSeparatorChar) return true;
+            return path.size() >= 2 && path[0] == unixSeparatorChar && path[1] == unixSeparatorChar;
         }
 
         PathType determinePathType(QStringView path, PathOs pathOs) {
@@ -40,76 +44,92 @@ namespace libtremotesf {
             throw std::logic_error("Unknown PathOs value");
         }
 
-        void convertFromNativeWindowsSeparators(QString& path) {
-            path.replace(windowsSeparatorChar, unixSeparatorChar);
-        }
-
         void convertToNativeWindowsSeparators(QString& path) { path.replace(unixSeparatorChar, windowsSeparatorChar); }
 
-        void capitalizeWindowsDriveLetter(QString& path) {
-            if (path.size() >= 2 && path[1] == ':') {
-                const auto drive = path[0];
-                if (drive.isLower()) {
-                    path[0] = drive.toUpper();
-                }
-            }
-        }
-
-        void collapseRepeatingSeparators(QString& path, PathType pathType) {
-            const auto& regex = [pathType]() -> const QRegularExpression& {
-                if (pathType == PathType::WindowsUNCOrDOSDevicePath) {
-                    // Don't collapse leading '//'
-                    static const QRegularExpression regex(R"((?!^)//+)"_l1);
-                    return regex;
-                }
-                static const QRegularExpression regex(R"(//+)"_l1);
-                return regex;
-            }();
-            path.replace(regex, unixSeparatorString);
-        }
-
-        void dropTrailingSeparator(QString& path, PathType pathType) {
-            const auto minimumLength = [pathType] {
-                switch (pathType) {
-                case PathType::Unix:
-                    return 1; // e.g. '/'
-                case PathType::WindowsAbsoluteDOSFilePath:
-                    return 3; // e.g. 'C:/'
-                case PathType::WindowsUNCOrDOSDevicePath:
-                    return 2; // e.g. '//'
-                }
-                throw std::logic_error("Unknown PathOs value");
-            }();
-            if (path.size() <= minimumLength) return;
-            if (path.back() == unixSeparatorChar) {
-                path.chop(1);
+        qsizetype minimumLengthForTrailingSeparator(PathType pathType) {
+            switch (pathType) {
+            case PathType::Unix:
+                return 1; // e.g. '/'
+            case PathType::WindowsAbsoluteDOSFilePath:
+                return 3; // e.g. 'C:/'
+            case PathType::WindowsUNCOrDOSDevicePath:
+                return 2; // e.g. '//'
             }
+            throw std::logic_error("Unknown PathOs value");
         }
     }
 
     bool isAbsoluteWindowsDOSFilePath(QStringView path) {
-        static const QRegularExpression regex(R"(^[A-Za-z]:[\\/].*$)"_l1);
-        return regex.match(path).hasMatch();
+        return path.size() >= 3 && isAsciiLetter(path[0]) && path[1] == ':' &&
+               (path[2] == windowsSeparatorChar || path[2] == unixSeparatorChar);
     }
 
     QString normalizePath(const QString& path, PathOs pathOs) {
         if (path.isEmpty()) {
             return path;
         }
-        QString normalized = path.trimmed();
-        if (normalized.isEmpty()) {
-            return normalized;
+        const QStringView trimmed = QStringView(path).trimmed();
+        if (trimmed.isEmpty()) {
+            return {};
+        }
+        const auto pathType = determinePathType(trimmed, pathOs);
+        const bool windows = pathType != PathType::Unix;
+        const bool capitalizeDriveLetter = pathType == PathType::WindowsAbsoluteDOSFilePath && trimmed.size() >= 2 &&
+                                           trimmed[1] == ':' && trimmed[0].isLower();
+
+        // Most paths are already normalized, so we don't allocate new string
+        // until we encounter first character that needs to be changed or dropped.
+        // Until then normalized path is a prefix of trimmed one with length `length`
+        QString normalized{};
+        qsizetype length{};
+        bool modified{};
+        const auto startModifying = [&] {
+            if (!modified) {
+                normalized = QStringView(trimmed.data(), length).toString();
+                modified = true;
+            }
+        };
+
+        QChar previous{};
+        for (qsizetype i = 0; i < trimmed.size(); ++i) {
+            const QChar original = trimmed[i];
+            QChar ch = original;
+            if (windows && ch == windowsSeparatorChar) {
+                ch = unixSeparatorChar;
+            } else if (i == 0 && capitalizeDriveLetter) {
+                ch = ch.toUpper();
+            }
+            if (ch == unixSeparatorChar && previous == unixSeparatorChar) {
+                // Don't collapse leading '//' of UNC paths
+                if (!(i == 1 && pathType == PathType::WindowsUNCOrDOSDevicePath)) {
+                    startModifying();
+                    continue;
+                }
+            }
+            if (ch != original) {
+                startModifying();
+            }
+            if (modified) {
+                normalized.append(ch);
+            }
+            previous = ch;
+            ++length;
         }
-        const auto pathType = determinePathType(normalized, pathOs);
-        if (pathType != PathType::Unix) {
-            convertFromNativeWindowsSeparators(normalized);
-            if (pathType == PathType::WindowsAbsoluteDOSFilePath) {
-                capitalizeWindowsDriveLetter(normalized);
+
+        if (previous == unixSeparatorChar && length > minimumLengthForTrailingSeparator(pathType)) {
+            if (modified) {
+                normalized.chop(1);
             }
+            --length;
+        }
+
+        if (modified) {
+            return normalized;
+        }
+        if (length == path.size()) {
+            return path;
         }
-        collapseRepeatingSeparators(normalized, pathType);
-        dropTrailingSeparator(normalized, pathType);
-        return normalized;
+        return QStringView(trimmed.data(), length).toString();
     }
 
     QString toNativeSeparators(const QString& path, PathOs pathOs) {
@@ -122,4 +142,27 @@ namespace libtremotesf {
         }
         return native;
     }
+
+    namespace impl {
+        QString NormalizedPathsCache::normalizePath(const QString& path, PathOs pathOs) {
+            auto& paths = (pathOs == PathOs::Windows) ? mWindowsPaths : mUnixPaths;
+            if (const auto found = paths.constFind(path); found != paths.constEnd()) {
+                return found.value();
+            }
+            if (size() >= maximumSize) {
+                // Distinct paths are expected to be few, so there is no point in tracking usage
+                clear();
+            }
+            QString normalized = internString(libtremotesf::normalizePath(path, pathOs));
+            paths.insert(path, normalized);
+            return normalized;
+        }
+
+        qsizetype NormalizedPathsCache::size() const { return mUnixPaths.size() + mWindowsPaths.size(); }
+
+        void NormalizedPathsCache::clear() {
+            mUnixPaths.clear();
+            mWindowsPaths.clear();
+        }
+    }
 }
@@ -5,6 +5,7 @@
 #ifndef TREMOTESF_RPC_PATHUTILS_H
 #define TREMOTESF_RPC_PATHUTILS_H
 
+#include <QHash>
 #include <QString>
 
 #include "target_os.h"
@@ -24,6 +25,27 @@ namespace libtremotesf {
 
     QString normalizePath(const QString& path, PathOs pathOs);
     QString toNativeSeparators(const QString& path, PathOs pathOs);
+
+    namespace impl {
+        /**
+         * Remembers results of normalizePath() for a small number of distinct raw paths
+         * Returned strings share storage with cached ones, so e.g. torrents in the same
+         * download directory don't get their own copies of it on every update
+         */
+        class NormalizedPathsCache {
+        public:
+            QString normalizePath(const QString& path, PathOs pathOs);
+
+            qsizetype size() const;
+            void clear();
+
+            static constexpr qsizetype maximumSize = 128;
+
+        private:
+            QHash<QString, QString> mUnixPaths{};
+            QHash<QString, QString> mWindowsPaths{};
+        };
+    }
 }
 
 namespace tremotesf {
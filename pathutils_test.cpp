@@ -5,6 +5,7 @@
 #include <array>
 #include <QTest>
 
+#include "literals.h"
 #include "pathutils.h"
 
 using namespace libtremotesf;
@@ -73,6 +74,34 @@ private slots:
         }
     }
 
+    void checkNormalizeReturnsSameStringIfNormalized() {
+        const QString path = "/home/foo"_l1;
+        QCOMPARE(normalizePath(path, PathOs::Unix).constData(), path.constData());
+        const QString windowsPath = "C:/home/foo"_l1;
+        QCOMPARE(normalizePath(windowsPath, PathOs::Windows).constData(), windowsPath.constData());
+    }
+
+    void checkNormalizedPathsCache() {
+        impl::NormalizedPathsCache cache{};
+
+        const QString first = cache.normalizePath(R"(C:\home\foo\)"_l1, PathOs::Windows);
+        QCOMPARE(first, "C:/home/foo"_l1);
+        const QString second = cache.normalizePath(R"(C:\home\foo\)"_l1, PathOs::Windows);
+        QCOMPARE(second, first);
+        QCOMPARE(second.constData(), first.constData());
+        QVERIFY(cache.size() == 1);
+
+        // Same raw path is normalized differently depending on PathOs
+        QCOMPARE(cache.normalizePath("//home//foo"_l1, PathOs::Unix), "/home/foo"_l1);
+        QCOMPARE(cache.normalizePath("//home//foo"_l1, PathOs::Windows), "//home/foo"_l1);
+        QVERIFY(cache.size() == 3);
+
+        for (qsizetype i = 0; i < impl::NormalizedPathsCache::maximumSize; ++i) {
+            cache.normalizePath(QString::number(i), PathOs::Unix);
+        }
+        QVERIFY(cache.size() <= impl::NormalizedPathsCache::maximumSize);
+    }
+
     void checkToNativeSeparators() {
         const auto testCases = std::array{
             NativeSeparatorsTestCase{"/", "/", PathOs::Unix},
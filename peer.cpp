@@ -4,17 +4,129 @@
 
 #include "peer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include <QHash>
+#include <QHostAddress>
 #include <QJsonObject>
+#include <QtEndian>
 
 #include "jsonutils.h"
 #include "literals.h"
+#include "log.h"
 #include "stdutils.h"
+#include "stringpool.h"
 
 namespace libtremotesf {
     using namespace impl;
 
-    Peer::Peer(QString&& address, const QJsonObject& peerJson)
-        : address(std::move(address)), client(peerJson.value("clientName"_l1).toString()) {
+    namespace {
+        struct FlagCharacter {
+            char character;
+            Peer::Flag flag;
+        };
+
+        // In the same order as Transmission puts them in flagStr
+        constexpr std::array flagCharacters{
+            FlagCharacter{'T', Peer::Flag::Utp},
+            FlagCharacter{'O', Peer::Flag::OptimisticUnchoke},
+            FlagCharacter{'D', Peer::Flag::DownloadingFrom},
+            FlagCharacter{'d', Peer::Flag::ClientIsInterested},
+            FlagCharacter{'U', Peer::Flag::UploadingTo},
+            FlagCharacter{'u', Peer::Flag::PeerIsInterested},
+            FlagCharacter{'K', Peer::Flag::ClientIsUnchokedButNotInterested},
+            FlagCharacter{'?', Peer::Flag::PeerIsUnchokedButNotInterested},
+            FlagCharacter{'E', Peer::Flag::Encrypted},
+            FlagCharacter{'H', Peer::Flag::FromDht},
+            FlagCharacter{'X', Peer::Flag::FromPex},
+            FlagCharacter{'I', Peer::Flag::Incoming}};
+
+        Peer::Flags parseFlags(const QString& flagsString, QString& unknownFlags) {
+            Peer::Flags flags{};
+            unknownFlags.clear();
+            for (const QChar ch : flagsString) {
+                const auto found = std::find_if(flagCharacters.begin(), flagCharacters.end(), [ch](const auto& flag) {
+                    return ch == QLatin1Char(flag.character);
+                });
+                if (found != flagCharacters.end()) {
+                    flags |= found->flag;
+                } else {
+                    unknownFlags.append(ch);
+                    logCWarningDeduplicated(jsonLog, QString(ch), "Unknown peer flag '{}'", QString(ch));
+                }
+            }
+            return flags;
+        }
+
+        // Transmission always sends IPv4 addresses in dotted-decimal form, so parse it by hand
+        // and leave everything else to QHostAddress
+        std::optional<std::array<uint8_t, 4>> parseIpv4Address(QStringView address) {
+            std::array<uint8_t, 4> bytes{};
+            size_t byteIndex = 0;
+            int value = -1;
+            for (const QChar ch : address) {
+                const auto code = ch.unicode();
+                if (code >= '0' && code <= '9') {
+                    value = (value == -1 ? 0 : value * 10) + (code - '0');
+                    if (value > 255) return std::nullopt;
+                } else if (code == '.' && value != -1 && byteIndex < 3) {
+                    bytes[byteIndex++] = static_cast<uint8_t>(value);
+                    value = -1;
+                } else {
+                    return std::nullopt;
+                }
+            }
+            if (value == -1 || byteIndex != 3) return std::nullopt;
+            bytes[byteIndex] = static_cast<uint8_t>(value);
+            return bytes;
+        }
+    }
+
+    PeerEndpoint PeerEndpoint::fromJson(const QJsonObject& peerJson) {
+        QString addressString = peerJson.value(Peer::addressKey).toString();
+        PeerEndpoint endpoint{};
+        endpoint.port = static_cast<uint16_t>(peerJson.value(Peer::portKey).toInt());
+        if (const auto ipv4 = parseIpv4Address(addressString); ipv4.has_value()) {
+            std::copy(ipv4->begin(), ipv4->end(), endpoint.address.begin());
+            return endpoint;
+        }
+        const QHostAddress address(addressString);
+        switch (address.protocol()) {
+        case QAbstractSocket::IPv4Protocol: {
+            const auto ipv4 = qToBigEndian(address.toIPv4Address());
+            std::memcpy(endpoint.address.data(), &ipv4, sizeof(ipv4));
+            return endpoint;
+        }
+        case QAbstractSocket::IPv6Protocol: {
+            const auto ipv6 = address.toIPv6Address();
+            std::memcpy(endpoint.address.data(), &ipv6, sizeof(ipv6));
+            endpoint.ipv6 = true;
+            return endpoint;
+        }
+        default:
+            // Peer is still shown, and is matched between updates by address string
+            logCWarningDeduplicated(jsonLog, addressString, "Invalid peer address '{}'", addressString);
+            endpoint.unparsedAddress = std::move(addressString);
+            return endpoint;
+        }
+    }
+
+    QString PeerEndpoint::addressString() const {
+        if (!unparsedAddress.isEmpty()) {
+            return unparsedAddress;
+        }
+        if (ipv6) {
+            Q_IPV6ADDR ipv6Address{};
+            std::memcpy(&ipv6Address, address.data(), sizeof(ipv6Address));
+            return QHostAddress(ipv6Address).toString();
+        }
+        return QHostAddress(qFromBigEndian<quint32>(address.data())).toString();
+    }
+
+    Peer::Peer(const PeerEndpoint& endpoint, const QJsonObject& peerJson)
+        : endpoint(endpoint), client(internString(peerJson.value("clientName"_l1).toString())) {
         update(peerJson);
     }
 
@@ -23,7 +135,33 @@ namespace libtremotesf {
         setChanged(downloadSpeed, toInt64(peerJson.value("rateToClient"_l1)), changed);
         setChanged(uploadSpeed, toInt64(peerJson.value("rateToPeer"_l1)), changed);
         setChanged(progress, peerJson.value("progress"_l1).toDouble(), changed);
-        setChanged(flags, peerJson.value("flagStr"_l1).toString(), changed);
+        QString newUnknownFlags{};
+        setChanged(flags, parseFlags(peerJson.value("flagStr"_l1).toString(), newUnknownFlags), changed);
+        setChanged(unknownFlags, std::move(newUnknownFlags), changed);
         return changed;
     }
+
+    QString Peer::flagsString() const {
+        QString string{};
+        for (const auto& [character, flag] : flagCharacters) {
+            if (flags.testFlag(flag)) {
+                string.append(QLatin1Char(character));
+            }
+        }
+        string.append(unknownFlags);
+        return string;
+    }
+}
+
+size_t std::hash<libtremotesf::PeerEndpoint>::operator()(const libtremotesf::PeerEndpoint& endpoint) const noexcept {
+    std::array<uint64_t, 2> parts{};
+    std::memcpy(parts.data(), endpoint.address.data(), sizeof(parts));
+    // Mix address halves and port so that peers from the same subnet don't collide
+    uint64_t value = (parts[0] * 0x9E3779B97F4A7C15ULL) ^ parts[1];
+    value ^= (static_cast<uint64_t>(endpoint.port) << 1) | static_cast<uint64_t>(endpoint.ipv6);
+    if (!endpoint.unparsedAddress.isEmpty()) {
+        value ^= static_cast<uint64_t>(qHash(endpoint.unparsedAddress)) << 17;
+    }
+    value = (value ^ (value >> 31)) * 0xBF58476D1CE4E5B9ULL;
+    return static_cast<size_t>(value ^ (value >> 32));
 }
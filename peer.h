@@ -5,29 +5,88 @@
 #ifndef LIBTREMOTESF_PEER_H
 #define LIBTREMOTESF_PEER_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include <QFlags>
 #include <QString>
 #include "literals.h"
 
 class QJsonObject;
 
 namespace libtremotesf {
+    /**
+     * IP address and port of a peer
+     * IPv4 address occupies first 4 bytes of address and the rest are zero
+     * Address that can't be parsed is kept as is in unparsedAddress (and address is zero)
+     */
+    struct PeerEndpoint {
+        static PeerEndpoint fromJson(const QJsonObject& peerJson);
+
+        QString addressString() const;
+
+        bool operator==(const PeerEndpoint& other) const = default;
+
+        std::array<uint8_t, 16> address{};
+        uint16_t port{};
+        bool ipv6{};
+        QString unparsedAddress{};
+    };
+
     struct Peer {
 #ifndef SWIG
         static constexpr auto addressKey = "address"_l1;
+        static constexpr auto portKey = "port"_l1;
 #endif
 
-        explicit Peer(QString&& address, const QJsonObject& peerJson);
+        /**
+         * Flags from Transmission's flagStr
+         */
+        enum class Flag : uint16_t {
+            Utp = 1 << 0,                              // T
+            OptimisticUnchoke = 1 << 1,                // O
+            DownloadingFrom = 1 << 2,                  // D
+            ClientIsInterested = 1 << 3,               // d
+            UploadingTo = 1 << 4,                      // U
+            PeerIsInterested = 1 << 5,                 // u
+            ClientIsUnchokedButNotInterested = 1 << 6, // K
+            PeerIsUnchokedButNotInterested = 1 << 7,   // ?
+            Encrypted = 1 << 8,                        // E
+            FromDht = 1 << 9,                          // H
+            FromPex = 1 << 10,                         // X
+            Incoming = 1 << 11                         // I
+        };
+        Q_DECLARE_FLAGS(Flags, Flag)
+
+        explicit Peer(const PeerEndpoint& endpoint, const QJsonObject& peerJson);
         bool update(const QJsonObject& peerJson);
 
+        QString address() const { return endpoint.addressString(); }
+        /**
+         * Known flags in Transmission's order followed by unknownFlags
+         */
+        QString flagsString() const;
+
         bool operator==(const Peer& other) const = default;
 
-        QString address{};
+        PeerEndpoint endpoint{};
         QString client{};
         qint64 downloadSpeed{};
         qint64 uploadSpeed{};
         double progress{};
-        QString flags{};
+        Flags flags{};
+        // Characters of flagStr that don't correspond to any Flag, in the order they were received
+        QString unknownFlags{};
     };
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(libtremotesf::Peer::Flags)
+
+template<>
+struct std::hash<libtremotesf::PeerEndpoint> {
+    size_t operator()(const libtremotesf::PeerEndpoint& endpoint) const noexcept;
+};
+
 #endif // LIBTREMOTESF_PEER_H
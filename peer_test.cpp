@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QJsonObject>
+#include <QTest>
+
+#include "literals.h"
+#include "peer.h"
+
+using namespace libtremotesf;
+
+class PeerTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parseIpv4Endpoint() {
+        const auto endpoint =
+            PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "192.168.1.20"_l1}, {Peer::portKey, 51413}});
+        QVERIFY(endpoint.unparsedAddress.isEmpty());
+        QVERIFY(!endpoint.ipv6);
+        QCOMPARE(endpoint.port, uint16_t{51413});
+        QCOMPARE(endpoint.addressString(), "192.168.1.20"_l1);
+    }
+
+    void parseIpv6Endpoint() {
+        const auto endpoint =
+            PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "2001:db8::1"_l1}, {Peer::portKey, 6881}});
+        QVERIFY(endpoint.unparsedAddress.isEmpty());
+        QVERIFY(endpoint.ipv6);
+        QCOMPARE(endpoint.addressString(), "2001:db8::1"_l1);
+    }
+
+    void parseInvalidEndpoint() {
+        const auto endpoint =
+            PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "256.1.1.1"_l1}, {Peer::portKey, 1}});
+        QCOMPARE(endpoint.unparsedAddress, "256.1.1.1"_l1);
+        QCOMPARE(endpoint.addressString(), "256.1.1.1"_l1);
+        QCOMPARE(endpoint.port, uint16_t{1});
+    }
+
+    void invalidEndpointsAreMatchedByAddressString() {
+        const auto first = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "foo"_l1}, {Peer::portKey, 1}});
+        const auto same = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "foo"_l1}, {Peer::portKey, 1}});
+        const auto other = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "bar"_l1}, {Peer::portKey, 1}});
+        QVERIFY(first == same);
+        QCOMPARE(std::hash<PeerEndpoint>{}(first), std::hash<PeerEndpoint>{}(same));
+        QVERIFY(first != other);
+    }
+
+    void endpointsWithDifferentPortsAreDifferent() {
+        const auto first = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}, {Peer::portKey, 1}});
+        const auto second = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}, {Peer::portKey, 2}});
+        QVERIFY(first != second);
+    }
+
+    void equalEndpointsHaveEqualHashes() {
+        const auto first = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}, {Peer::portKey, 1}});
+        const auto second = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}, {Peer::portKey, 1}});
+        QCOMPARE(std::hash<PeerEndpoint>{}(first), std::hash<PeerEndpoint>{}(second));
+    }
+
+    void flags() {
+        const auto endpoint = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}});
+        Peer peer(endpoint, QJsonObject{{"flagStr"_l1, "TDUEX"_l1}});
+        QVERIFY(peer.flags.testFlag(Peer::Flag::Utp));
+        QVERIFY(peer.flags.testFlag(Peer::Flag::DownloadingFrom));
+        QVERIFY(peer.flags.testFlag(Peer::Flag::UploadingTo));
+        QVERIFY(peer.flags.testFlag(Peer::Flag::Encrypted));
+        QVERIFY(peer.flags.testFlag(Peer::Flag::FromPex));
+        QVERIFY(!peer.flags.testFlag(Peer::Flag::Incoming));
+        QCOMPARE(peer.flagsString(), "TDUEX"_l1);
+
+        QVERIFY(peer.update(QJsonObject{{"flagStr"_l1, "dI"_l1}}));
+        QCOMPARE(peer.flagsString(), "dI"_l1);
+        QVERIFY(!peer.update(QJsonObject{{"flagStr"_l1, "dI"_l1}}));
+    }
+
+    void unknownFlagsArePreserved() {
+        const auto endpoint = PeerEndpoint::fromJson(QJsonObject{{Peer::addressKey, "10.0.0.1"_l1}});
+        Peer peer(endpoint, QJsonObject{{"flagStr"_l1, "TZD"_l1}});
+        QVERIFY(peer.flags.testFlag(Peer::Flag::Utp));
+        QVERIFY(peer.flags.testFlag(Peer::Flag::DownloadingFrom));
+        QCOMPARE(peer.unknownFlags, "Z"_l1);
+        QCOMPARE(peer.flagsString(), "TDZ"_l1);
+
+        QVERIFY(peer.update(QJsonObject{{"flagStr"_l1, "TD"_l1}}));
+        QVERIFY(peer.unknownFlags.isEmpty());
+    }
+};
+
+QTEST_MAIN(PeerTest)
+
+#include "peer_test.moc"
@@ -125,7 +125,7 @@ namespace libtremotesf::impl {
     RequestRouter::RequestRouter(QObject* parent) : RequestRouter(nullptr, parent) {}
 
     void RequestRouter::setConfiguration(RequestsConfiguration configuration) {
-        logDebug("Setting requests configuration");
+        logCDebug(requestsLog, "Setting requests configuration");
 
         mConfiguration = std::move(configuration);
 
@@ -152,13 +152,13 @@ namespace libtremotesf::impl {
         }
 
         if (!mConfiguration->serverUrl.isEmpty()) {
-            logDebug("Connection configuration:");
-            logDebug(" - Server url: {}", mConfiguration->serverUrl.toString());
+            logCDebug(requestsLog, "Connection configuration:");
+            logCDebug(requestsLog, " - Server url: {}", mConfiguration->serverUrl.toString());
             if (mConfiguration->proxy.type() != QNetworkProxy::NoProxy) {
-                logDebug(" - Proxy: {}", mConfiguration->proxy);
+                logCDebug(requestsLog, " - Proxy: {}", mConfiguration->proxy);
             }
-            logDebug(" - Timeout: {}", mConfiguration->timeout);
-            logDebug(" - HTTP Basic access authentication: {}", mConfiguration->authentication);
+            logCDebug(requestsLog, " - Timeout: {}", mConfiguration->timeout);
+            logCDebug(requestsLog, " - HTTP Basic access authentication: {}", mConfiguration->authentication);
             if (mConfiguration->authentication) {
                 auto base64Credentials = QString("%1:%2")
                                              .arg(mConfiguration->username, mConfiguration->password)
@@ -169,16 +169,18 @@ namespace libtremotesf::impl {
             }
             if (https) {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 1, 0)
-                logDebug(" - Available TLS backends: {}", QSslSocket::availableBackends());
-                logDebug(" - Active TLS backend: {}", QSslSocket::activeBackend());
-                logDebug(" - Supported TLS protocols: {}", QSslSocket::supportedProtocols());
+                logCDebug(requestsLog, " - Available TLS backends: {}", QSslSocket::availableBackends());
+                logCDebug(requestsLog, " - Active TLS backend: {}", QSslSocket::activeBackend());
+                logCDebug(requestsLog, " - Supported TLS protocols: {}", QSslSocket::supportedProtocols());
 #endif
-                logDebug(" - TLS library version: {}", QSslSocket::sslLibraryVersionString());
-                logDebug(
+                logCDebug(requestsLog, " - TLS library version: {}", QSslSocket::sslLibraryVersionString());
+                logCDebug(
+                    requestsLog,
                     " - Manually validating server's certificate chain: {}",
                     !mConfiguration->serverCertificateChain.isEmpty()
                 );
-                logDebug(
+                logCDebug(
+                    requestsLog,
                     " - Client certificate authentication: {}",
                     !mConfiguration->clientCertificate.isNull() && !mConfiguration->clientPrivateKey.isNull()
                 );
@@ -187,7 +189,7 @@ namespace libtremotesf::impl {
     }
 
     void RequestRouter::resetConfiguration() {
-        logDebug("Resetting requests configuration");
+        logCDebug(requestsLog, "Resetting requests configuration");
         mConfiguration.reset();
         mNetwork->clearAccessCache();
     }
@@ -202,7 +204,7 @@ namespace libtremotesf::impl {
         QLatin1String method, const QByteArray& data, RequestType type, std::function<void(Response)>&& onResponse
     ) {
         if (!mConfiguration.has_value()) {
-            logWarning("Requests configuration is not set");
+            logCWarning(requestsLog, "Requests configuration is not set");
             return;
         }
 
@@ -279,14 +281,19 @@ namespace libtremotesf::impl {
 
     bool RequestRouter::retryRequest(const QNetworkRequest& request, NetworkRequestMetadata&& metadata) {
         if (!mConfiguration.has_value()) {
-            logWarning("Not retrying request, requests configuration is not set");
+            logCWarning(requestsLog, "Not retrying request, requests configuration is not set");
             return false;
         }
         metadata.retryAttempts++;
         if (metadata.retryAttempts > mConfiguration->retryAttempts) {
             return false;
         }
-        logWarning("Retrying '{}' request, retry attempts = {}", metadata.rpcMetadata.method, metadata.retryAttempts);
+        logCWarning(
+            requestsLog,
+            "Retrying '{}' request, retry attempts = {}",
+            metadata.rpcMetadata.method,
+            metadata.retryAttempts
+        );
         postRequest(request, std::move(metadata));
         return true;
     }
@@ -305,7 +312,8 @@ namespace libtremotesf::impl {
     }
 
     void RequestRouter::onRequestSuccess(QNetworkReply* reply, RpcRequestMetadata&& metadata) {
-        logDebug(
+        logCDebug(
+            requestsLog,
             "HTTP request for method '{}' succeeded, HTTP status code: {} {}",
             metadata.method,
             reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(),
@@ -317,7 +325,8 @@ namespace libtremotesf::impl {
                 QJsonParseError error{};
                 QJsonObject json = QJsonDocument::fromJson(replyData, &error).object();
                 if (error.error != QJsonParseError::NoError) {
-                    logWarning(
+                    logCWarning(
+                        requestsLog,
                         "Failed to parse JSON reply from server:\n{}\nError '{}' at offset {}",
                         replyData,
                         error.errorString(),
@@ -338,7 +347,7 @@ namespace libtremotesf::impl {
             if (json.has_value()) {
                 const bool success = isResultSuccessful(*json);
                 if (!success) {
-                    logWarning("method '{}' failed, response: {}", metadata.method, *json);
+                    logCWarning(requestsLog, "method '{}' failed, response: {}", metadata.method, *json);
                 }
                 if (metadata.onResponse) {
                     metadata.onResponse({.arguments = getReplyArguments(*json), .success = success});
@@ -361,9 +370,14 @@ namespace libtremotesf::impl {
             // to handle case when current session id have already been overwritten by another failed request
             if (newSessionId != reply->request().rawHeader(sessionIdHeader)) {
                 if (!mSessionId.isEmpty()) {
-                    logInfo("Session id changed");
+                    logCInfo(requestsLog, "Session id changed");
                 }
-                logDebug("Session id is {}, retrying '{}' request", newSessionId, metadata.rpcMetadata.method);
+                logCDebug(
+                    requestsLog,
+                    "Session id is {}, retrying '{}' request",
+                    newSessionId,
+                    metadata.rpcMetadata.method
+                );
                 mSessionId = std::move(newSessionId);
                 // Retry without incrementing retryAttempts
                 postRequest(reply->request(), std::move(metadata));
@@ -372,15 +386,20 @@ namespace libtremotesf::impl {
         }
 
         const QString detailedErrorMessage = makeDetailedErrorMessage(reply, std::move(sslErrors));
-        logWarning("HTTP request for method '{}' failed:\n{}", metadata.rpcMetadata.method, detailedErrorMessage);
+        logCWarning(
+            requestsLog,
+            "HTTP request for method '{}' failed:\n{}",
+            metadata.rpcMetadata.method,
+            detailedErrorMessage
+        );
         switch (reply->error()) {
         case QNetworkReply::AuthenticationRequiredError:
-            logWarning("Authentication error");
+            logCWarning(requestsLog, "Authentication error");
             emit requestFailed(RpcError::AuthenticationError, reply->errorString(), detailedErrorMessage);
             break;
         case QNetworkReply::OperationCanceledError:
         case QNetworkReply::TimeoutError:
-            logWarning("Timed out");
+            logCWarning(requestsLog, "Timed out");
             if (!retryRequest(reply->request(), std::move(metadata))) {
                 emit requestFailed(RpcError::TimedOut, reply->errorString(), detailedErrorMessage);
             }
@@ -4,7 +4,11 @@
 
 #include "rpc.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
 #include <QFutureWatcher>
 #include <QJsonArray>
@@ -51,7 +55,7 @@ namespace libtremotesf {
           mServerStats(new ServerStats(this)) {
         mAutoReconnectTimer->setSingleShot(true);
         QObject::connect(mAutoReconnectTimer, &QTimer::timeout, this, [=, this] {
-            logInfo("Auto reconnection");
+            logCInfo(rpcLog, "Auto reconnection");
             connect();
         });
 
@@ -65,7 +69,7 @@ namespace libtremotesf {
             [=, this](RpcError error, const QString& errorMessage, const QString& detailedErrorMessage) {
                 setStatus({RpcConnectionState::Disconnected, error, errorMessage, detailedErrorMessage});
                 if (mAutoReconnectEnabled && !mUpdateDisabled) {
-                    logInfo("Auto reconnecting in {} seconds", mAutoReconnectTimer->interval() / 1000);
+                    logCInfo(rpcLog, "Auto reconnecting in {} seconds", mAutoReconnectTimer->interval() / 1000);
                     mAutoReconnectTimer->start();
                 }
             }
@@ -81,12 +85,13 @@ namespace libtremotesf {
     const std::vector<std::unique_ptr<Torrent>>& Rpc::torrents() const { return mTorrents; }
 
     Torrent* Rpc::torrentByHash(const QString& hash) const {
-        for (const std::unique_ptr<Torrent>& torrent : mTorrents) {
-            if (torrent->data().hashString == hash) {
-                return torrent.get();
-            }
-        }
-        return nullptr;
+        const auto parsed = InfoHash::fromHexString(hash);
+        return parsed.has_value() ? torrentByHash(*parsed) : nullptr;
+    }
+
+    Torrent* Rpc::torrentByHash(const InfoHash& hash) const {
+        const auto found = mTorrentsByHash.find(hash);
+        return (found == mTorrentsByHash.end()) ? nullptr : found->second;
     }
 
     Torrent* Rpc::torrentById(int id) const {
@@ -132,6 +137,121 @@ namespace libtremotesf {
         }
     }
 
+    bool Rpc::isChangeSetsEnabled() const { return mChangeSetsEnabled; }
+
+    void Rpc::setChangeSetsEnabled(bool enabled) { mChangeSetsEnabled = enabled; }
+
+    bool Rpc::isSnapshotsEnabled() const { return mSnapshotsEnabled; }
+
+    void Rpc::setSnapshotsEnabled(bool enabled) {
+        if (enabled == mSnapshotsEnabled) return;
+        mSnapshotsEnabled = enabled;
+        if (enabled) {
+            publishTorrentsSnapshot();
+        } else {
+            mTorrentsSnapshot.store(nullptr);
+        }
+    }
+
+    std::shared_ptr<const TorrentsSnapshot> Rpc::torrentsSnapshot() const { return mTorrentsSnapshot.load(); }
+
+    size_t Rpc::changeJournalCapacity() const { return mChangeJournal.capacity(); }
+
+    void Rpc::setChangeJournalCapacity(size_t capacity) { mChangeJournal.setCapacity(capacity, mTorrents.empty()); }
+
+    TorrentsDelta Rpc::torrentsChangesSince(quint64 version) const { return mChangeJournal.changesSince(version); }
+
+    const TrackersDirectory& Rpc::trackersDirectory() const { return mTrackersDirectory; }
+
+    int Rpc::idlePeersPollingInterval() const { return mIdlePeersPollingInterval; }
+
+    void Rpc::setIdlePeersPollingInterval(int updates) { mIdlePeersPollingInterval = std::max(updates, 1); }
+
+    const QString& Rpc::transferStatsDirectory() const { return mTransferStatsDirectory; }
+
+    void Rpc::setTransferStatsDirectory(const QString& directory) {
+        // Setting the same directory again retries opening stores after failure
+        if (directory == mTransferStatsDirectory && (directory.isEmpty() || mServerTransferStats)) return;
+        mTransferStatsDirectory = directory;
+        mServerTransferStats.reset();
+        for (const auto& torrent : mTorrents) {
+            torrent->closeTransferStats();
+        }
+        if (directory.isEmpty()) return;
+        try {
+            if (!QDir().mkpath(directory)) {
+                throw QFileError(fmt::format("Failed to create directory {}", directory));
+            }
+            mServerTransferStats = std::make_unique<TransferStatsStore>(QDir(directory).filePath("server"_l1));
+        } catch (const QFileError& e) {
+            logCWarningDeduplicated(
+                rpcLog,
+                directory,
+                "Failed to open server transfer stats in {}: {}",
+                directory,
+                e.what()
+            );
+        }
+    }
+
+    const TransferStatsStore* Rpc::serverTransferStats() const { return mServerTransferStats.get(); }
+
+    size_t Rpc::listsMemoryBudget() const { return mListsMemoryBudget; }
+
+    void Rpc::setListsMemoryBudget(size_t bytes) {
+        mListsMemoryBudget = bytes;
+        enforceListsMemoryBudget();
+    }
+
+    size_t Rpc::residentListsBytes() const {
+        size_t bytes = 0;
+        for (const auto& torrent : mTorrents) {
+            bytes += torrent->listsResidentBytes();
+        }
+        return bytes;
+    }
+
+    void Rpc::enforceListsMemoryBudget(std::span<const Torrent* const> keep) {
+        if (mListsMemoryBudget == 0) {
+            return;
+        }
+        size_t totalBytes = 0;
+        std::vector<Torrent*> resident{};
+        for (const auto& torrent : mTorrents) {
+            if (const auto bytes = torrent->listsResidentBytes(); bytes != 0) {
+                totalBytes += bytes;
+                // Evicting lists that have just been loaded would cause them to be reloaded again and again
+                if (std::find(keep.begin(), keep.end(), torrent.get()) == keep.end()) {
+                    resident.push_back(torrent.get());
+                }
+            }
+        }
+        if (totalBytes <= mListsMemoryBudget) {
+            return;
+        }
+        std::sort(resident.begin(), resident.end(), [](const Torrent* first, const Torrent* second) {
+            return first->listsLastAccessTime() < second->listsLastAccessTime();
+        });
+        for (Torrent* torrent : resident) {
+            if (totalBytes <= mListsMemoryBudget) {
+                break;
+            }
+            totalBytes -= torrent->listsResidentBytes();
+            logCDebug(rpcLog, "Evicting files and peers of torrent {} to stay within memory budget", *torrent);
+            torrent->evictLists();
+        }
+    }
+
+    void Rpc::publishTorrentsSnapshot() {
+        auto snapshot = std::make_shared<TorrentsSnapshot>();
+        snapshot->version = ++mLastSnapshotVersion;
+        snapshot->torrents.reserve(mTorrents.size());
+        for (const auto& torrent : mTorrents) {
+            snapshot->torrents.push_back(torrent->dataSnapshot());
+        }
+        mTorrentsSnapshot.store(std::move(snapshot));
+    }
+
     void Rpc::setConnectionConfiguration(const ConnectionConfiguration& configuration) {
         disconnect();
 
@@ -143,31 +263,31 @@ namespace libtremotesf {
         }
         requestsConfig.serverUrl.setHost(configuration.address);
         if (auto error = requestsConfig.serverUrl.errorString(); !error.isEmpty()) {
-            logWarning("Error setting URL hostname: {}", error);
+            logCWarning(rpcLog, "Error setting URL hostname: {}", error);
         }
         requestsConfig.serverUrl.setPort(configuration.port);
         if (auto error = requestsConfig.serverUrl.errorString(); !error.isEmpty()) {
-            logWarning("Error setting URL port: {}", error);
+            logCWarning(rpcLog, "Error setting URL port: {}", error);
         }
         if (auto i = configuration.apiPath.indexOf('?'); i != -1) {
             requestsConfig.serverUrl.setPath(configuration.apiPath.mid(0, i));
             if (auto error = requestsConfig.serverUrl.errorString(); !error.isEmpty()) {
-                logWarning("Error setting URL path: {}", error);
+                logCWarning(rpcLog, "Error setting URL path: {}", error);
             }
             if ((i + 1) < configuration.apiPath.size()) {
                 requestsConfig.serverUrl.setQuery(configuration.apiPath.mid(i + 1));
                 if (auto error = requestsConfig.serverUrl.errorString(); !error.isEmpty()) {
-                    logWarning("Error setting URL query: {}", error);
+                    logCWarning(rpcLog, "Error setting URL query: {}", error);
                 }
             }
         } else {
             requestsConfig.serverUrl.setPath(configuration.apiPath);
             if (auto error = requestsConfig.serverUrl.errorString(); !error.isEmpty()) {
-                logWarning("Error setting URL path: {}", error);
+                logCWarning(rpcLog, "Error setting URL path: {}", error);
             }
         }
         if (!requestsConfig.serverUrl.isValid()) {
-            logWarning("URL {} is invalid", requestsConfig.serverUrl);
+            logCWarning(rpcLog, "URL {} is invalid", requestsConfig.serverUrl);
         }
 
         switch (configuration.proxyType) {
@@ -253,7 +373,7 @@ namespace libtremotesf {
         try {
             openFile(*file, QIODevice::ReadOnly);
         } catch (const QFileError& e) {
-            logWarningWithException(e, "addTorrentFile: failed to open torrent file");
+            logCWarningWithException(rpcLog, e, "addTorrentFile: failed to open torrent file");
             emit torrentAddError();
             return;
         }
@@ -295,7 +415,7 @@ namespace libtremotesf {
                      {"paused"_l1, !start}}
                 );
             } catch (const QFileError& e) {
-                logWarningWithException(e, "addTorrentFile: failed to read torrent file");
+                logCWarningWithException(rpcLog, e, "addTorrentFile: failed to read torrent file");
                 emit torrentAddError();
                 return std::nullopt;
             }
@@ -544,23 +664,33 @@ namespace libtremotesf {
     }
 
     void Rpc::getTorrentsFiles(std::span<const int> ids, bool asDataUpdate) {
+        // Names and sizes of files never change, so they are requested only until they are loaded
+        const bool filesLoaded = std::all_of(ids.begin(), ids.end(), [&](int id) {
+            const Torrent* torrent = torrentById(id);
+            return torrent && torrent->isFilesLoaded();
+        });
         mRequestRouter->postRequest(
             "torrent-get"_l1,
-            {{"fields"_l1, QJsonArray{"id"_l1, "files"_l1, "fileStats"_l1}}, {"ids"_l1, toJsonArray(ids)}},
+            {{"fields"_l1,
+              filesLoaded ? QJsonArray{"id"_l1, "fileStats"_l1} : QJsonArray{"id"_l1, "files"_l1, "fileStats"_l1}},
+             {"ids"_l1, toJsonArray(ids)}},
             asDataUpdate ? RequestRouter::RequestType::DataUpdate : RequestRouter::RequestType::Independent,
             [=, this](const RequestRouter::Response& response) {
                 if (response.success) {
                     const QJsonArray torrents(response.arguments.value(torrentsKey).toArray());
+                    std::vector<const Torrent*> loaded{};
                     for (const auto& torrentJson : torrents) {
                         const auto object = torrentJson.toObject();
                         const auto torrentId = Torrent::idFromJson(object);
                         if (torrentId.has_value()) {
                             Torrent* torrent = torrentById(*torrentId);
-                            if (torrent && torrent->isFilesEnabled()) {
+                            if (torrent && torrent->isFilesEnabled() && !torrent->isListsEvicted()) {
                                 torrent->updateFiles(object);
+                                loaded.push_back(torrent);
                             }
                         }
                     }
+                    enforceListsMemoryBudget(loaded);
                     if (asDataUpdate) {
                         maybeFinishUpdateOrConnection();
                     }
@@ -577,16 +707,19 @@ namespace libtremotesf {
             [=, this](const RequestRouter::Response& response) {
                 if (response.success) {
                     const QJsonArray torrents(response.arguments.value(torrentsKey).toArray());
+                    std::vector<const Torrent*> loaded{};
                     for (const auto& torrentJson : torrents) {
                         const auto object = torrentJson.toObject();
                         const auto torrentId = Torrent::idFromJson(object);
                         if (torrentId.has_value()) {
                             Torrent* torrent = torrentById(*torrentId);
-                            if (torrent && torrent->isPeersEnabled()) {
+                            if (torrent && torrent->isPeersEnabled() && !torrent->isListsEvicted()) {
                                 torrent->updatePeers(object);
+                                loaded.push_back(torrent);
                             }
                         }
                     }
+                    enforceListsMemoryBudget(loaded);
                     if (asDataUpdate) {
                         maybeFinishUpdateOrConnection();
                     }
@@ -603,13 +736,26 @@ namespace libtremotesf {
                 RequestRouter::RequestType::Independent,
                 [=, this](const RequestRouter::Response& response) {
                     if (response.success) {
-                        Torrent* torrent = torrentById(torrentId);
-                        if (torrent) {
+                        const auto found = std::find_if(mTorrents.begin(), mTorrents.end(), [&](const auto& torrent) {
+                            return torrent->data().id == torrentId;
+                        });
+                        if (found != mTorrents.end()) {
+                            Torrent* torrent = found->get();
                             const QString path(response.arguments.value("path"_l1).toString());
                             const QString newName(response.arguments.value("name"_l1).toString());
-                            emit torrent->fileRenamed(path, newName);
+                            // Files and name of torrent are patched locally, without waiting for next update
+                            if (torrent->applyFileRename(path, newName)) {
+                                TorrentData::UpdateKeySet changedKeys{};
+                                changedKeys.set(static_cast<size_t>(TorrentData::UpdateKey::Name));
+                                std::vector<TorrentsChangeSet::ChangedTorrent> changedTorrents{
+                                    {.index = static_cast<int>(found - mTorrents.begin()), .changedKeys = changedKeys}
+                                };
+                                emitTorrentsChanged(std::move(changedTorrents));
+                            }
+                            if (const auto notifier = torrent->notifierIfCreated(); notifier) {
+                                emit notifier->fileRenamed(path, newName);
+                            }
                             emit torrentFileRenamed(torrentId, path, newName);
-                            updateData();
                         }
                     }
                 }
@@ -658,7 +804,7 @@ namespace libtremotesf {
 
     void Rpc::updateData() {
         if (connectionState() != ConnectionState::Disconnected && !mUpdating) {
-            logDebug("Updating data");
+            logCDebug(rpcLog, "Updating data");
             mUpdateTimer->stop();
             mUpdating = true;
             if (isConnected()) {
@@ -667,7 +813,8 @@ namespace libtremotesf {
             getTorrents();
             getServerStats();
         } else {
-            logWarning(
+            logCWarning(
+                rpcLog,
                 "updateData: called in incorrect state, connectionState = {}, updating = {}",
                 connectionState(),
                 mUpdating
@@ -683,7 +830,7 @@ namespace libtremotesf {
                 RequestRouter::RequestType::Independent,
                 [=, this](const RequestRouter::Response& response) {
                     if (response.success) {
-                        logInfo("Successfully sent shutdown request, disconnecting");
+                        logCInfo(rpcLog, "Successfully sent shutdown request, disconnecting");
                         disconnect();
                     }
                 }
@@ -724,7 +871,7 @@ namespace libtremotesf {
     void Rpc::resetStateOnConnectionStateChanged(ConnectionState oldConnectionState, size_t& removedTorrentsCount) {
         switch (mStatus.connectionState) {
         case ConnectionState::Disconnected: {
-            logInfo("Disconnected");
+            logCInfo(rpcLog, "Disconnected");
 
             mRequestRouter->cancelPendingRequestsAndClearSessionId();
 
@@ -738,18 +885,32 @@ namespace libtremotesf {
 
             if (!mTorrents.empty() && oldConnectionState == ConnectionState::Connected) {
                 removedTorrentsCount = mTorrents.size();
+                if (mChangeJournal.capacity() != 0) {
+                    mChangeJournal.record(
+                        {},
+                        {},
+                        createTransforming<std::vector<int>>(mTorrents, [](const auto& torrent) {
+                            return torrent->data().id;
+                        })
+                    );
+                }
                 emit onAboutToRemoveTorrents(0, removedTorrentsCount);
                 mTorrents.clear();
+                mTorrentsByHash.clear();
+                mTrackersDirectory.clear();
+                if (mSnapshotsEnabled) {
+                    publishTorrentsSnapshot();
+                }
                 emit onRemovedTorrents(0, removedTorrentsCount);
             }
 
             break;
         }
         case ConnectionState::Connecting:
-            logInfo("Connecting");
+            logCInfo(rpcLog, "Connecting");
             break;
         case ConnectionState::Connected: {
-            logInfo("Connected");
+            logCInfo(rpcLog, "Connected");
             break;
         }
         }
@@ -763,6 +924,11 @@ namespace libtremotesf {
             if (oldConnectionState == ConnectionState::Connected) {
                 emit connectedChanged();
                 emit torrentsUpdated({{0, static_cast<int>(removedTorrentsCount)}}, {}, 0);
+                if (mChangeSetsEnabled) {
+                    auto changeSet = std::make_shared<TorrentsChangeSet>();
+                    changeSet->removedIndexRanges.emplace_back(0, static_cast<int>(removedTorrentsCount));
+                    emit torrentsChangeSetReady(changeSet);
+                }
             }
             break;
         }
@@ -771,6 +937,15 @@ namespace libtremotesf {
             break;
         case ConnectionState::Connected: {
             emit torrentsUpdated({}, {}, torrentsCount());
+            if (mChangeSetsEnabled) {
+                auto changeSet = std::make_shared<TorrentsChangeSet>();
+                changeSet->addedCount = torrentsCount();
+                changeSet->addedIds.reserve(mTorrents.size());
+                for (const auto& torrent : mTorrents) {
+                    changeSet->addedIds.push_back(torrent->data().id);
+                }
+                emit torrentsChangeSetReady(changeSet);
+            }
             emit connectionStateChanged();
             emit connectedChanged();
             break;
@@ -815,7 +990,35 @@ namespace libtremotesf {
     class TorrentsListUpdater final : public ItemListUpdater<std::unique_ptr<Torrent>, std::vector<NewTorrent>> {
 
     public:
-        inline explicit TorrentsListUpdater(Rpc& rpc) : mRpc(rpc) {}
+        inline explicit TorrentsListUpdater(Rpc& rpc)
+            : mRpc(rpc), mCollectChangeSet(rpc.isChangeSetsEnabled() || rpc.changeJournalCapacity() != 0) {}
+
+        void recordInJournal(TorrentsChangeJournal& journal) {
+            std::vector<std::pair<int, TorrentData::UpdateKeySet>> changed{};
+            changed.reserve(mChangedIds.size());
+            for (size_t i = 0; i < mChangedIds.size(); ++i) {
+                changed.emplace_back(mChangedIds[i], mChangedKeys[i]);
+            }
+            journal.record(std::move(changed), std::vector(mAddedIds), std::vector(mRemovedIds));
+        }
+
+        std::shared_ptr<const TorrentsChangeSet> takeChangeSet() {
+            auto changeSet = std::make_shared<TorrentsChangeSet>();
+            changeSet->removedIndexRanges = removedIndexRanges;
+            changeSet->changedIndexRanges = changedIndexRanges;
+            changeSet->addedCount = addedCount;
+            // updateItem() returns true for changed torrents in the same order as their indexes are reported
+            changeSet->changedTorrents.reserve(mChangedKeys.size());
+            auto keys = mChangedKeys.begin();
+            for (const auto& [first, last] : changedIndexRanges) {
+                for (int index = first; index < last && keys != mChangedKeys.end(); ++index, ++keys) {
+                    changeSet->changedTorrents.push_back({.index = index, .changedKeys = *keys});
+                }
+            }
+            changeSet->addedIds = std::move(mAddedIds);
+            changeSet->finishedIds = std::move(mFinishedIds);
+            return changeSet;
+        }
 
         const std::vector<std::optional<TorrentData::UpdateKey>>* keys{};
         std::vector<std::pair<int, int>> removedIndexRanges{};
@@ -833,6 +1036,13 @@ namespace libtremotesf {
         }
 
         void onAboutToRemoveItems(size_t first, size_t last) override {
+            for (size_t i = first; i < last; ++i) {
+                removeFromHashIndex(i);
+                mRpc.mTrackersDirectory.removeTorrent(mRpc.mTorrents[i]->data().id);
+                if (mCollectChangeSet) {
+                    mRemovedIds.push_back(mRpc.mTorrents[i]->data().id);
+                }
+            }
             emit mRpc.onAboutToRemoveTorrents(first, last);
         };
 
@@ -848,10 +1058,16 @@ namespace libtremotesf {
             const bool metadataWasComplete = torrent->data().metadataComplete;
 
             bool changed{};
+            TorrentData::UpdateKeySet changedKeys{};
+            auto* const changedKeysPointer = mCollectChangeSet ? &changedKeys : nullptr;
             if (keys) {
-                changed = torrent->update(*keys, newTorrent.json.toArray());
+                changed = torrent->update(*keys, newTorrent.json.toArray(), changedKeysPointer);
             } else {
-                changed = torrent->update(newTorrent.json.toObject());
+                changed = torrent->update(newTorrent.json.toObject(), changedKeysPointer);
+            }
+            if (changed && mCollectChangeSet) {
+                mChangedIds.push_back(newTorrent.id);
+                mChangedKeys.push_back(changedKeys);
             }
             if (changed) {
                 // Don't emit torrentFinished() if torrent's size became smaller
@@ -860,6 +1076,9 @@ namespace libtremotesf {
                 if (!wasFinished && torrent->data().isFinished() && !wasPaused &&
                     torrent->data().sizeWhenDone >= oldSizeWhenDone) {
                     emit mRpc.torrentFinished(torrent.get());
+                    if (mCollectChangeSet) {
+                        mFinishedIds.push_back(newTorrent.id);
+                    }
                 }
                 if (!metadataWasComplete && torrent->data().metadataComplete) {
                     metadataCompletedIds.push_back(newTorrent.id);
@@ -881,6 +1100,12 @@ namespace libtremotesf {
             } else {
                 torrent = std::make_unique<Torrent>(newTorrent.id, newTorrent.json.toObject(), &mRpc);
             }
+            if (mCollectChangeSet) {
+                mAddedIds.push_back(newTorrent.id);
+            }
+            if (!torrent->data().hash.isEmpty()) {
+                mRpc.mTorrentsByHash.emplace(torrent->data().hash, torrent.get());
+            }
             if (mRpc.isConnected()) {
                 emit mRpc.torrentAdded(torrent.get());
             }
@@ -898,7 +1123,23 @@ namespace libtremotesf {
         };
 
     private:
+        void removeFromHashIndex(size_t index) {
+            const Torrent* torrent = mRpc.mTorrents[index].get();
+            const auto found = mRpc.mTorrentsByHash.find(torrent->data().hash);
+            // With duplicate hashes, entry may point to another torrent
+            if (found == mRpc.mTorrentsByHash.end() || found->second != torrent) {
+                return;
+            }
+            mRpc.mTorrentsByHash.erase(found);
+        }
+
         Rpc& mRpc;
+        bool mCollectChangeSet{};
+        std::vector<int> mChangedIds{};
+        std::vector<TorrentData::UpdateKeySet> mChangedKeys{};
+        std::vector<int> mAddedIds{};
+        std::vector<int> mRemovedIds{};
+        std::vector<int> mFinishedIds{};
     };
 
     void Rpc::getTorrents() {
@@ -957,19 +1198,49 @@ namespace libtremotesf {
                     }
                 }
 
+                if (mSnapshotsEnabled) {
+                    publishTorrentsSnapshot();
+                }
+                if (mChangeJournal.capacity() != 0) {
+                    updater.recordInJournal(mChangeJournal);
+                }
+
                 if (!updater.metadataCompletedIds.empty()) {
                     checkTorrentsSingleFile(updater.metadataCompletedIds);
                 }
+                std::vector<int> getTrackersIds{};
                 std::vector<int> getFilesIds{};
                 std::vector<int> getPeersIds{};
+                const auto currentTimeSecs = QDateTime::currentSecsSinceEpoch();
                 for (const auto& torrent : mTorrents) {
+                    torrent->recordSpeedHistory(currentTimeSecs);
+                    torrent->recordTransferStats(currentTimeSecs);
+                    if (torrent->shouldPollTrackers(currentTimeSecs)) {
+                        getTrackersIds.push_back(torrent->data().id);
+                    }
+                    if (torrent->isListsEvicted()) {
+                        if (!torrent->takeListsReloadRequest()) {
+                            continue;
+                        }
+                        // Reload both lists regardless of peers polling policy
+                        if (torrent->isFilesEnabled()) {
+                            getFilesIds.push_back(torrent->data().id);
+                        }
+                        if (torrent->isPeersEnabled()) {
+                            getPeersIds.push_back(torrent->data().id);
+                        }
+                        continue;
+                    }
                     if (torrent->isFilesEnabled()) {
                         getFilesIds.push_back(torrent->data().id);
                     }
-                    if (torrent->isPeersEnabled()) {
+                    if (torrent->shouldPollPeers(mIdlePeersPollingInterval)) {
                         getPeersIds.push_back(torrent->data().id);
                     }
                 }
+                if (!getTrackersIds.empty()) {
+                    getTorrentsTrackers(getTrackersIds);
+                }
                 if (!getFilesIds.empty()) {
                     getTorrentsFiles(getFilesIds, true);
                 }
@@ -981,11 +1252,90 @@ namespace libtremotesf {
                 maybeFinishUpdateOrConnection();
                 if (!wasConnecting) {
                     emit torrentsUpdated(updater.removedIndexRanges, updater.changedIndexRanges, updater.addedCount);
+                    if (mChangeSetsEnabled) {
+                        emit torrentsChangeSetReady(updater.takeChangeSet());
+                    }
+                }
+            }
+        );
+    }
+
+    void Rpc::getTorrentsTrackers(std::span<const int> torrentIds) {
+        mRequestRouter->postRequest(
+            "torrent-get"_l1,
+            {{"fields"_l1, Torrent::trackersUpdateFields()}, {"ids"_l1, toJsonArray(torrentIds)}},
+            RequestRouter::RequestType::DataUpdate,
+            [=, this](const RequestRouter::Response& response) {
+                if (!response.success) {
+                    return;
                 }
+                std::unordered_map<int, QJsonObject> torrentJsons{};
+                for (const auto& torrentJson : response.arguments.value(torrentsKey).toArray()) {
+                    auto object = torrentJson.toObject();
+                    if (const auto torrentId = Torrent::idFromJson(object); torrentId.has_value()) {
+                        torrentJsons.emplace(*torrentId, std::move(object));
+                    }
+                }
+                std::vector<TorrentsChangeSet::ChangedTorrent> changedTorrents{};
+                for (size_t i = 0; i < mTorrents.size(); ++i) {
+                    const auto& torrent = mTorrents[i];
+                    const auto found = torrentJsons.find(torrent->data().id);
+                    if (found != torrentJsons.end()) {
+                        TorrentData::UpdateKeySet changedKeys{};
+                        if (torrent->update(found->second, &changedKeys)) {
+                            changedTorrents.push_back({.index = static_cast<int>(i), .changedKeys = changedKeys});
+                            if (changedKeys.test(static_cast<size_t>(TorrentData::UpdateKey::TrackerStats))) {
+                                mTrackersDirectory.updateTorrent(torrent->data().id, torrent->data().trackers);
+                            }
+                        }
+                    }
+                }
+                // When connecting, torrents will be reported as added when connection is completed
+                if (!changedTorrents.empty() && connectionState() == ConnectionState::Connected) {
+                    emitTorrentsChanged(std::move(changedTorrents));
+                }
+                maybeFinishUpdateOrConnection();
             }
         );
     }
 
+    void Rpc::emitTorrentsChanged(std::vector<TorrentsChangeSet::ChangedTorrent>&& changedTorrents) {
+        std::vector<std::pair<int, int>> changedIndexRanges{};
+        for (const auto& changed : changedTorrents) {
+            if (!changedIndexRanges.empty() && changedIndexRanges.back().second == changed.index) {
+                ++changedIndexRanges.back().second;
+            } else {
+                changedIndexRanges.emplace_back(changed.index, changed.index + 1);
+            }
+        }
+        for (const auto& [first, last] : changedIndexRanges) {
+            emit onChangedTorrents(static_cast<size_t>(first), static_cast<size_t>(last));
+        }
+
+        if (mSnapshotsEnabled) {
+            publishTorrentsSnapshot();
+        }
+        if (mChangeJournal.capacity() != 0) {
+            std::vector<std::pair<int, TorrentData::UpdateKeySet>> changed{};
+            changed.reserve(changedTorrents.size());
+            for (const auto& torrent : changedTorrents) {
+                changed.emplace_back(mTorrents[static_cast<size_t>(torrent.index)]->data().id, torrent.changedKeys);
+            }
+            std::sort(changed.begin(), changed.end(), [](const auto& first, const auto& second) {
+                return first.first < second.first;
+            });
+            mChangeJournal.record(std::move(changed), {}, {});
+        }
+
+        emit torrentsUpdated({}, changedIndexRanges, 0);
+        if (mChangeSetsEnabled) {
+            auto changeSet = std::make_shared<TorrentsChangeSet>();
+            changeSet->changedIndexRanges = std::move(changedIndexRanges);
+            changeSet->changedTorrents = std::move(changedTorrents);
+            emit torrentsChangeSetReady(changeSet);
+        }
+    }
+
     void Rpc::checkTorrentsSingleFile(std::span<const int> torrentIds) {
         mRequestRouter->postRequest(
             "torrent-get"_l1,
@@ -1018,6 +1368,14 @@ namespace libtremotesf {
             [=, this](const RequestRouter::Response& response) {
                 if (response.success) {
                     mServerStats->update(response.arguments);
+                    if (mServerTransferStats) {
+                        const auto total = mServerStats->total();
+                        mServerTransferStats->append(
+                            QDateTime::currentSecsSinceEpoch(),
+                            total.downloaded(),
+                            total.uploaded()
+                        );
+                    }
                     maybeFinishUpdateOrConnection();
                 }
             }
@@ -1033,7 +1391,7 @@ namespace libtremotesf {
         if (!mUpdating && !connecting) return;
         if (mUpdating) {
             if (checkIfUpdateCompleted()) {
-                logDebug("Finished updating data");
+                logCDebug(rpcLog, "Finished updating data");
                 mUpdating = false;
             } else {
                 return;
@@ -1052,34 +1410,34 @@ namespace libtremotesf {
     }
 
     void Rpc::checkIfServerIsLocal() {
-        logInfo("checkIfServerIsLocal() called");
+        logCInfo(rpcLog, "checkIfServerIsLocal() called");
         if (mServerSettings->data().hasSessionIdFile() && !mRequestRouter->sessionId().isEmpty() &&
             isTransmissionSessionIdFileExists(mRequestRouter->sessionId())) {
             mServerIsLocal = true;
-            logInfo("checkIfServerIsLocal: server is running locally: true");
+            logCInfo(rpcLog, "checkIfServerIsLocal: server is running locally: true");
             return;
         }
         const auto host = mRequestRouter->configuration()->serverUrl.host();
         if (auto localIp = isLocalIpAddress(host); localIp.has_value()) {
             mServerIsLocal = *localIp;
-            logInfo("checkIfServerIsLocal: server is running locally: {}", *mServerIsLocal);
+            logCInfo(rpcLog, "checkIfServerIsLocal: server is running locally: {}", *mServerIsLocal);
             return;
         }
-        logInfo("checkIfServerIsLocal: resolving IP address for host name {}", host);
+        logCInfo(rpcLog, "checkIfServerIsLocal: resolving IP address for host name {}", host);
         mPendingHostInfoLookupId = QHostInfo::lookupHost(host, this, [=, this](const QHostInfo& info) {
-            logInfo("checkIfServerIsLocal: resolved IP address for host name {}", host);
+            logCInfo(rpcLog, "checkIfServerIsLocal: resolved IP address for host name {}", host);
             const auto addresses = info.addresses();
             if (!addresses.isEmpty()) {
-                logInfo("checkIfServerIsLocal: IP addresses:");
+                logCInfo(rpcLog, "checkIfServerIsLocal: IP addresses:");
                 for (const auto& address : addresses) {
-                    logInfo("checkIfServerIsLocal: - {}", address);
+                    logCInfo(rpcLog, "checkIfServerIsLocal: - {}", address);
                 }
-                logInfo("checkIfServerIsLocal: checking first address");
+                logCInfo(rpcLog, "checkIfServerIsLocal: checking first address");
                 mServerIsLocal = isLocalIpAddress(addresses.first());
             } else {
                 mServerIsLocal = false;
             }
-            logInfo("checkIfServerIsLocal: server is running locally: {}", *mServerIsLocal);
+            logCInfo(rpcLog, "checkIfServerIsLocal: server is running locally: {}", *mServerIsLocal);
             mPendingHostInfoLookupId = std::nullopt;
             maybeFinishUpdateOrConnection();
         });
@@ -8,15 +8,20 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include <QByteArray>
 #include <QObject>
 
+#include "changejournal.h"
 #include "formatters.h"
 #include "serversettings.h"
 #include "serverstats.h"
+#include "stdutils.h"
 #include "torrent.h"
+#include "trackersdirectory.h"
+#include "transferstatsstore.h"
 
 class QFile;
 class QTimer;
@@ -77,6 +82,36 @@ namespace libtremotesf {
     };
     Q_ENUM_NS(RpcError)
 
+    /**
+     * Everything that changed in torrents list during one update
+     * Indexes are the same as in torrentsUpdated() signal
+     */
+    struct TorrentsChangeSet {
+        std::vector<std::pair<int, int>> removedIndexRanges{};
+        std::vector<std::pair<int, int>> changedIndexRanges{};
+        int addedCount{};
+
+        struct ChangedTorrent {
+            int index{};
+            TorrentData::UpdateKeySet changedKeys{};
+        };
+        // One for each torrent in changedIndexRanges, in ascending order of index
+        std::vector<ChangedTorrent> changedTorrents{};
+
+        std::vector<int> addedIds{};
+        std::vector<int> finishedIds{};
+    };
+
+    /**
+     * Immutable copy of torrents list, see Rpc::torrentsSnapshot()
+     */
+    struct TorrentsSnapshot {
+        // Incremented with each published snapshot
+        quint64 version{};
+        // In the same order as Rpc::torrents()
+        std::vector<std::shared_ptr<const TorrentData>> torrents{};
+    };
+
     class Rpc : public QObject {
         Q_OBJECT
     public:
@@ -92,6 +127,7 @@ namespace libtremotesf {
 
         const std::vector<std::unique_ptr<Torrent>>& torrents() const;
         libtremotesf::Torrent* torrentByHash(const QString& hash) const;
+        libtremotesf::Torrent* torrentByHash(const InfoHash& hash) const;
         Torrent* torrentById(int id) const;
 
         struct Status {
@@ -116,6 +152,76 @@ namespace libtremotesf {
         bool isUpdateDisabled() const;
         void setUpdateDisabled(bool disabled);
 
+        /**
+         * When enabled, torrentsChangeSetReady() is emitted with the same information as
+         * torrentsUpdated() and other torrent list signals, plus keys of changed properties of each torrent
+         */
+        bool isChangeSetsEnabled() const;
+        void setChangeSetsEnabled(bool enabled);
+
+        /**
+         * When enabled, new TorrentsSnapshot is published after each torrents update
+         * and when disconnecting. Data of torrents that didn't change is shared with previous snapshot
+         */
+        bool isSnapshotsEnabled() const;
+        void setSnapshotsEnabled(bool enabled);
+        /**
+         * Latest published snapshot, or null if snapshots are disabled
+         * Can be called from any thread
+         */
+        std::shared_ptr<const TorrentsSnapshot> torrentsSnapshot() const;
+
+        /**
+         * Number of torrents list updates that are kept for torrentsChangesSince()
+         * 0 (default) disables change journal
+         */
+        size_t changeJournalCapacity() const;
+        void setChangeJournalCapacity(size_t capacity);
+        /**
+         * Returns merged changes of torrents list since given version
+         * Consumers start from version 0 and then pass TorrentsDelta::version from previous call
+         * When TorrentsDelta::fullResyncNeeded is true (e.g. journal was enabled with torrents already loaded),
+         * consumer should reread whole torrents list and continue from returned version
+         */
+        TorrentsDelta torrentsChangesSince(quint64 version) const;
+
+        /**
+         * Statistics of trackers of all torrents by tracker site
+         */
+        const TrackersDirectory& trackersDirectory() const;
+
+        /**
+         * Peers of idle torrents are polled once in this number of updates (10 by default)
+         * See Torrent::setPeersPolling()
+         */
+        int idlePeersPollingInterval() const;
+        void setIdlePeersPollingInterval(int updates);
+
+        /**
+         * Memory budget for files and peers lists of all torrents. When it is exceeded, lists of
+         * least recently accessed torrents are evicted (see torrentListsEvicted()) and are not polled
+         * until they are accessed again
+         * 0 (default) means no limit
+         */
+        size_t listsMemoryBudget() const;
+        void setListsMemoryBudget(size_t bytes);
+        /**
+         * Approximate memory used by files and peers lists of all torrents, see Torrent::listsResidentBytes()
+         */
+        size_t residentListsBytes() const;
+
+        /**
+         * Directory where totals of server and of torrents with Torrent::setTransferStatsEnabled()
+         * are persisted after each update. It should be different for each server
+         * Empty (default) disables it. Setting the same directory again retries opening stores that failed to open
+         */
+        const QString& transferStatsDirectory() const;
+        void setTransferStatsDirectory(const QString& directory);
+        /**
+         * Persisted totals of server, or null if transfer stats directory is not set
+         */
+        const TransferStatsStore* serverTransferStats() const;
+
         void setConnectionConfiguration(const ConnectionConfiguration& configuration);
         void resetConnectionConfiguration();
 
@@ -178,12 +284,16 @@ namespace libtremotesf {
         void shutdownServer();
 
     private:
+        friend class TorrentsListUpdater;
+
         void setStatus(Status&& status);
         void resetStateOnConnectionStateChanged(ConnectionState oldConnectionState, size_t& removedTorrentsCount);
         void emitSignalsOnConnectionStateChanged(ConnectionState oldConnectionState, size_t removedTorrentsCount);
 
         void getServerSettings();
         void getTorrents();
+        void getTorrentsTrackers(std::span<const int> torrentIds);
+        void emitTorrentsChanged(std::vector<TorrentsChangeSet::ChangedTorrent>&& changedTorrents);
         void checkTorrentsSingleFile(std::span<const int> torrentIds);
         void getServerStats();
 
@@ -193,10 +303,23 @@ namespace libtremotesf {
 
         void checkIfServerIsLocal();
 
+        void publishTorrentsSnapshot();
+        void enforceListsMemoryBudget(std::span<const Torrent* const> keep = {});
+
         impl::RequestRouter* mRequestRouter{};
 
         bool mUpdateDisabled{};
         bool mUpdating{};
+        bool mChangeSetsEnabled{};
+        bool mSnapshotsEnabled{};
+        quint64 mLastSnapshotVersion{};
+        impl::AtomicSharedPtr<const TorrentsSnapshot> mTorrentsSnapshot{};
+        impl::TorrentsChangeJournal mChangeJournal{};
+        TrackersDirectory mTrackersDirectory{};
+        size_t mListsMemoryBudget{};
+        int mIdlePeersPollingInterval{10};
+        QString mTransferStatsDirectory{};
+        std::unique_ptr<TransferStatsStore> mServerTransferStats{};
 
         bool mAutoReconnectEnabled{};
 
@@ -209,6 +332,7 @@ namespace libtremotesf {
         ServerSettings* mServerSettings{};
         // Don't use member initializer to workaround Android NDK bug (https://github.com/android/ndk/issues/1798)
         std::vector<std::unique_ptr<Torrent>> mTorrents;
+        std::unordered_map<InfoHash, Torrent*> mTorrentsByHash;
         ServerStats* mServerStats{};
 
         Status mStatus{};
@@ -232,6 +356,8 @@ namespace libtremotesf {
             int addedCount
         );
 
+        void torrentsChangeSetReady(const std::shared_ptr<const libtremotesf::TorrentsChangeSet>& changeSet);
+
         void torrentFilesUpdated(const libtremotesf::Torrent* torrent, const std::vector<int>& changedIndexes);
         void torrentPeersUpdated(
             const libtremotesf::Torrent* torrent,
@@ -241,6 +367,8 @@ namespace libtremotesf {
         );
 
         void torrentFileRenamed(int torrentId, const QString& filePath, const QString& newName);
+        // See TorrentNotifier::listsEvicted()
+        void torrentListsEvicted(const libtremotesf::Torrent* torrent);
 
         void torrentAdded(libtremotesf::Torrent* torrent);
         void torrentFinished(libtremotesf::Torrent* torrent);
@@ -4,6 +4,7 @@
 
 #include "serverstats.h"
 
+#include <QDateTime>
 #include <QJsonObject>
 
 #include "jsonutils.h"
@@ -22,6 +23,7 @@ namespace libtremotesf {
     void ServerStats::update(const QJsonObject& serverStats) {
         mDownloadSpeed = toInt64(serverStats.value("downloadSpeed"_l1));
         mUploadSpeed = toInt64(serverStats.value("uploadSpeed"_l1));
+        mSpeedHistory.append(QDateTime::currentSecsSinceEpoch(), mDownloadSpeed, mUploadSpeed);
         mCurrentSession.update(serverStats.value("current-stats"_l1).toObject());
         mTotal.update(serverStats.value("cumulative-stats"_l1).toObject());
         emit updated();
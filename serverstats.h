@@ -7,6 +7,8 @@
 
 #include <QObject>
 
+#include "speedhistory.h"
+
 class QJsonObject;
 
 namespace libtremotesf {
@@ -39,6 +41,7 @@ namespace libtremotesf {
 
         [[nodiscard]] SessionStats currentSession() const { return mCurrentSession; };
         [[nodiscard]] SessionStats total() const { return mTotal; };
+        [[nodiscard]] const SpeedHistory& speedHistory() const { return mSpeedHistory; }
 
         void update(const QJsonObject& serverStats);
 
@@ -47,6 +50,7 @@ namespace libtremotesf {
         qint64 mUploadSpeed{};
         SessionStats mCurrentSession{};
         SessionStats mTotal{};
+        SpeedHistory mSpeedHistory{};
     signals:
         void updated();
     };
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "speedhistory.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace libtremotesf {
+    namespace {
+        constexpr std::array resolutions{
+            SpeedHistory::Resolution::Second,
+            SpeedHistory::Resolution::Minute,
+            SpeedHistory::Resolution::Hour};
+
+        uint32_t quantize(qint64 value) {
+            return static_cast<uint32_t>(std::clamp<qint64>(value, 0, std::numeric_limits<uint32_t>::max()));
+        }
+    }
+
+    void SpeedHistory::append(qint64 timeSecs, qint64 downloadSpeed, qint64 uploadSpeed) {
+        if (timeSecs < mLastTimeSecs) {
+            return;
+        }
+        mLastTimeSecs = timeSecs;
+        for (size_t i = 0; i < resolutions.size(); ++i) {
+            mLevels[i].append(timeSecs, downloadSpeed, uploadSpeed, resolutions[i]);
+        }
+    }
+
+    std::vector<SpeedHistory::Sample> SpeedHistory::samples(Resolution resolution) const {
+        std::vector<Sample> samples{};
+        mLevels[static_cast<size_t>(resolution)].appendTo(samples);
+        return samples;
+    }
+
+    size_t SpeedHistory::memoryUsage() const {
+        size_t bytes = sizeof(*this);
+        for (const auto& level : mLevels) {
+            bytes += level.memoryUsage();
+        }
+        return bytes;
+    }
+
+    void SpeedHistory::Level::append(qint64 timeSecs, qint64 downloadSpeed, qint64 uploadSpeed, Resolution resolution) {
+        const qint64 startSecs = timeSecs - timeSecs % intervalSecs(resolution);
+        if (startSecs != mCurrentStartSecs) {
+            if (mCount != 0) {
+                push(
+                    {.timeSecs = quantize(mCurrentStartSecs),
+                     .downloadSpeed = quantize(mDownloadSum / mCount),
+                     .uploadSpeed = quantize(mUploadSum / mCount)},
+                    resolution
+                );
+            }
+            mCurrentStartSecs = startSecs;
+            mDownloadSum = 0;
+            mUploadSum = 0;
+            mCount = 0;
+        }
+        mDownloadSum += downloadSpeed;
+        mUploadSum += uploadSpeed;
+        ++mCount;
+    }
+
+    void SpeedHistory::Level::appendTo(std::vector<Sample>& samples) const {
+        samples.reserve(mRing.size() + 1);
+        // When ring is not full yet mHead is 0 and samples are already in order
+        for (size_t i = 0; i < mRing.size(); ++i) {
+            const auto& sample = mRing[(mHead + i) % mRing.size()];
+            samples.push_back(
+                {.timeSecs = sample.timeSecs, .downloadSpeed = sample.downloadSpeed, .uploadSpeed = sample.uploadSpeed}
+            );
+        }
+        if (mCount != 0) {
+            samples.push_back(
+                {.timeSecs = mCurrentStartSecs,
+                 .downloadSpeed = mDownloadSum / mCount,
+                 .uploadSpeed = mUploadSum / mCount}
+            );
+        }
+    }
+
+    void SpeedHistory::Level::push(const StoredSample& sample, Resolution resolution) {
+        const size_t maxSize = capacity(resolution);
+        if (mRing.size() < maxSize) {
+            if (mRing.capacity() == 0) {
+                mRing.reserve(maxSize);
+            }
+            mRing.push_back(sample);
+        } else {
+            mRing[mHead] = sample;
+            mHead = (mHead + 1) % maxSize;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_SPEEDHISTORY_H
+#define LIBTREMOTESF_SPEEDHISTORY_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace libtremotesf {
+    /**
+     * Download and upload speeds history with several resolutions
+     * Each resolution is a fixed-size ring buffer of averages over its interval,
+     * so memory usage doesn't grow and appending is O(1)
+     *
+     * Only intervals that received at least one sample are stored: gaps are not filled,
+     * and consumers can see them from timeSecs of adjacent samples.
+     * Average of interval is an arithmetic mean of its samples, not weighted by time between them.
+     * Rpc appends speeds after each update, so with regular update interval they are equally spaced anyway
+     */
+    class SpeedHistory {
+    public:
+        enum class Resolution { Second, Minute, Hour };
+
+        struct Sample {
+            // Start of interval
+            qint64 timeSecs{};
+            // Average speeds in bytes per second
+            qint64 downloadSpeed{};
+            qint64 uploadSpeed{};
+
+            bool operator==(const Sample& other) const = default;
+        };
+
+        static constexpr int intervalSecs(Resolution resolution) {
+            switch (resolution) {
+            case Resolution::Second:
+                return 1;
+            case Resolution::Minute:
+                return 60;
+            case Resolution::Hour:
+                return 3600;
+            }
+            return 1;
+        }
+
+        /**
+         * Maximum number of stored intervals (not counting current one). Since only intervals with samples
+         * are stored, this is a bound on time span only when samples are at least as frequent as resolution:
+         * 600 seconds (10 minutes), 1440 minutes (1 day) and 720 hours (30 days).
+         * E.g. with update every 5 seconds Second resolution holds last 600 updates, i.e. 50 minutes
+         */
+        static constexpr size_t capacity(Resolution resolution) {
+            switch (resolution) {
+            case Resolution::Second:
+                return 600;
+            case Resolution::Minute:
+                return 1440;
+            case Resolution::Hour:
+                return 720;
+            }
+            return 0;
+        }
+
+        /**
+         * Samples must be appended in chronological order. Samples older than last one are ignored
+         */
+        void append(qint64 timeSecs, qint64 downloadSpeed, qint64 uploadSpeed);
+
+        /**
+         * Returns completed intervals from oldest to newest, followed by current interval
+         */
+        std::vector<Sample> samples(Resolution resolution) const;
+
+        size_t memoryUsage() const;
+
+    private:
+        // Quantized to 12 bytes
+        struct StoredSample {
+            uint32_t timeSecs{};
+            uint32_t downloadSpeed{};
+            uint32_t uploadSpeed{};
+        };
+
+        class Level {
+        public:
+            void append(qint64 timeSecs, qint64 downloadSpeed, qint64 uploadSpeed, Resolution resolution);
+            void appendTo(std::vector<Sample>& samples) const;
+            size_t memoryUsage() const { return mRing.capacity() * sizeof(StoredSample); }
+
+        private:
+            void push(const StoredSample& sample, Resolution resolution);
+
+            std::vector<StoredSample> mRing{};
+            size_t mHead{};
+
+            // Interval that is being accumulated
+            qint64 mCurrentStartSecs{-1};
+            qint64 mDownloadSum{};
+            qint64 mUploadSum{};
+            qint64 mCount{};
+        };
+
+        std::array<Level, 3> mLevels{};
+        qint64 mLastTimeSecs{-1};
+    };
+}
+
+#endif // LIBTREMOTESF_SPEEDHISTORY_H
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstdint>
+#include <limits>
+
+#include <QTest>
+
+#include "speedhistory.h"
+
+using namespace libtremotesf;
+
+class SpeedHistoryTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void averagesIntervals() {
+        SpeedHistory history{};
+        history.append(60, 100, 10);
+        history.append(90, 300, 30);
+        history.append(120, 1000, 0);
+
+        const auto minutes = history.samples(SpeedHistory::Resolution::Minute);
+        QVERIFY(minutes.size() == 2);
+        QVERIFY(minutes[0] == (SpeedHistory::Sample{.timeSecs = 60, .downloadSpeed = 200, .uploadSpeed = 20}));
+        // Current interval
+        QVERIFY(minutes[1] == (SpeedHistory::Sample{.timeSecs = 120, .downloadSpeed = 1000, .uploadSpeed = 0}));
+
+        const auto seconds = history.samples(SpeedHistory::Resolution::Second);
+        QVERIFY(seconds.size() == 3);
+        QCOMPARE(seconds[1].timeSecs, qint64{90});
+
+        QVERIFY(history.samples(SpeedHistory::Resolution::Hour).size() == 1);
+    }
+
+    void ringBufferIsBounded() {
+        SpeedHistory history{};
+        constexpr auto capacity = SpeedHistory::capacity(SpeedHistory::Resolution::Second);
+        constexpr qint64 count = static_cast<qint64>(capacity) * 2;
+        for (qint64 i = 0; i < count; ++i) {
+            history.append(i, i, 0);
+        }
+        const auto memoryUsage = history.memoryUsage();
+
+        const auto seconds = history.samples(SpeedHistory::Resolution::Second);
+        // Full ring and current interval
+        QVERIFY(seconds.size() == capacity + 1);
+        QCOMPARE(seconds.front().timeSecs, count - static_cast<qint64>(capacity) - 1);
+        QCOMPARE(seconds.back().timeSecs, count - 1);
+        for (size_t i = 1; i < seconds.size(); ++i) {
+            QCOMPARE(seconds[i].timeSecs, seconds[i - 1].timeSecs + 1);
+        }
+
+        for (qint64 i = count; i < count * 2; ++i) {
+            history.append(i, i, 0);
+        }
+        QCOMPARE(history.memoryUsage(), memoryUsage);
+    }
+
+    void negativeAndHugeSpeedsAreClamped() {
+        SpeedHistory history{};
+        history.append(0, -5, qint64{1} << 40);
+        history.append(1, 0, 0);
+        const auto seconds = history.samples(SpeedHistory::Resolution::Second);
+        QCOMPARE(seconds.front().downloadSpeed, qint64{0});
+        QCOMPARE(seconds.front().uploadSpeed, qint64{std::numeric_limits<uint32_t>::max()});
+    }
+
+    void gapsAreNotFilled() {
+        SpeedHistory history{};
+        history.append(0, 100, 10);
+        history.append(5, 300, 30);
+        const auto seconds = history.samples(SpeedHistory::Resolution::Second);
+        QVERIFY(seconds.size() == 2);
+        QCOMPARE(seconds[0].timeSecs, qint64{0});
+        QCOMPARE(seconds[1].timeSecs, qint64{5});
+        // Unweighted mean of samples
+        QCOMPARE(history.samples(SpeedHistory::Resolution::Minute).front().downloadSpeed, qint64{200});
+    }
+
+    void oldSamplesAreIgnored() {
+        SpeedHistory history{};
+        history.append(10, 1, 1);
+        history.append(5, 100, 100);
+        QVERIFY(history.samples(SpeedHistory::Resolution::Second).size() == 1);
+    }
+};
+
+QTEST_MAIN(SpeedHistoryTest)
+
+#include "speedhistory_test.moc"
@@ -6,10 +6,14 @@
 #define LIBTREMOTESF_STDUTILS_H
 
 #include <algorithm>
+#include <atomic>
 #include <concepts>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <type_traits>
+#include <version>
 
 #include <QtGlobal>
 
@@ -37,6 +41,44 @@ namespace libtremotesf {
         template<std::ranges::range T>
         using MaybeMovableRangeReference = std::
             conditional_t<MovableRange<T>, std::ranges::range_rvalue_reference_t<T>, std::ranges::range_reference_t<T>>;
+
+        /**
+         * shared_ptr that can be loaded and stored concurrently
+         * Uses std::atomic<std::shared_ptr> where standard library supports it, and mutex otherwise
+         * (std::atomic_load/atomic_store overloads for shared_ptr are deprecated)
+         */
+        template<typename T>
+        class AtomicSharedPtr {
+        public:
+            std::shared_ptr<T> load() const {
+#ifdef __cpp_lib_atomic_shared_ptr
+                return mPointer.load(std::memory_order_acquire);
+#else
+                const std::lock_guard lock(mMutex);
+                return mPointer;
+#endif
+            }
+
+            void store(std::shared_ptr<T> pointer) {
+#ifdef __cpp_lib_atomic_shared_ptr
+                mPointer.store(std::move(pointer), std::memory_order_release);
+#else
+                {
+                    const std::lock_guard lock(mMutex);
+                    mPointer.swap(pointer);
+                }
+                // Previous value is released outside of lock
+#endif
+            }
+
+        private:
+#ifdef __cpp_lib_atomic_shared_ptr
+            std::atomic<std::shared_ptr<T>> mPointer{};
+#else
+            mutable std::mutex mMutex{};
+            std::shared_ptr<T> mPointer{};
+#endif
+        };
     }
 
     template<std::ranges::random_access_range Range>
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stringpool.h"
+
+#include <algorithm>
+
+namespace libtremotesf::impl {
+    StringPool& StringPool::instance() {
+        static StringPool pool{};
+        return pool;
+    }
+
+    QString StringPool::intern(const QString& string) {
+        if (string.isEmpty()) {
+            return {};
+        }
+        const std::lock_guard lock(mMutex);
+        if (const auto found = mStrings.constFind(string); found != mStrings.constEnd()) {
+            return *found;
+        }
+        if (mStrings.size() >= mRemoveUnusedThreshold) {
+            removeUnusedLocked();
+            mRemoveUnusedThreshold =
+                std::max(minimumRemoveUnusedThreshold, static_cast<qsizetype>(mStrings.size()) * 2);
+        }
+        mStrings.insert(string);
+        return string;
+    }
+
+    qsizetype StringPool::size() const {
+        const std::lock_guard lock(mMutex);
+        return mStrings.size();
+    }
+
+    void StringPool::removeUnused() {
+        const std::lock_guard lock(mMutex);
+        removeUnusedLocked();
+    }
+
+    void StringPool::removeUnusedLocked() {
+        // String is unused if pool holds the only reference to it
+        for (auto i = mStrings.begin(); i != mStrings.end();) {
+            i = i->isDetached() ? mStrings.erase(i) : ++i;
+        }
+    }
+}
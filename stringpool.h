@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_STRINGPOOL_H
+#define LIBTREMOTESF_STRINGPOOL_H
+
+#include <mutex>
+
+#include <QSet>
+#include <QString>
+
+namespace libtremotesf::impl {
+    /**
+     * Hash-consing pool of implicitly shared strings
+     * intern() returns a string that shares storage with equal string already in the pool,
+     * so values repeated across torrents, trackers and peers are stored only once
+     * and equal interned strings have the same constData().
+     * Strings that are no longer used outside of the pool are dropped when it grows.
+     * Thread-safe
+     */
+    class StringPool {
+    public:
+        static StringPool& instance();
+
+        QString intern(const QString& string);
+
+        qsizetype size() const;
+        void removeUnused();
+
+        static constexpr qsizetype minimumRemoveUnusedThreshold = 1024;
+
+    private:
+        void removeUnusedLocked();
+
+        mutable std::mutex mMutex{};
+        QSet<QString> mStrings{};
+        qsizetype mRemoveUnusedThreshold{minimumRemoveUnusedThreshold};
+    };
+
+    inline QString internString(const QString& string) { return StringPool::instance().intern(string); }
+
+    /**
+     * Like setChanged(), but for fields that hold interned strings
+     * Interned strings with different content never share storage, so we can skip comparison
+     * when they do
+     */
+    inline void setChangedInterned(QString& value, const QString& newValue, bool& changed) {
+        QString interned = internString(newValue);
+        if (interned.constData() == value.constData()) {
+            return;
+        }
+        if (interned != value) {
+            changed = true;
+        }
+        value = std::move(interned);
+    }
+}
+
+#endif // LIBTREMOTESF_STRINGPOOL_H
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+
+#include "literals.h"
+#include "stringpool.h"
+
+using namespace libtremotesf;
+using namespace libtremotesf::impl;
+
+class StringPoolTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void equalStringsShareStorage() {
+        const QString first = internString(QString("/home/foo/Downloads"_l1));
+        const QString second = internString(QString("/home/foo/Downloads"_l1));
+        QCOMPARE(first, "/home/foo/Downloads"_l1);
+        QCOMPARE(second.constData(), first.constData());
+
+        const QString other = internString(QString("/home/foo/Videos"_l1));
+        QVERIFY(other.constData() != first.constData());
+    }
+
+    void emptyStringsAreNotStored() {
+        const auto size = StringPool::instance().size();
+        QVERIFY(internString(QString()).isEmpty());
+        QVERIFY(internString(""_l1).isEmpty());
+        QCOMPARE(StringPool::instance().size(), size);
+    }
+
+    void unusedStringsAreRemoved() {
+        StringPool pool{};
+        QString used = pool.intern("used"_l1);
+        pool.intern("unused"_l1);
+        QVERIFY(pool.size() == 2);
+        pool.removeUnused();
+        QVERIFY(pool.size() == 1);
+        QCOMPARE(pool.intern("used"_l1).constData(), used.constData());
+    }
+
+    void setChangedInternedKeepsSharedStorage() {
+        QString value{};
+        bool changed = false;
+        setChangedInterned(value, "foo"_l1, changed);
+        QVERIFY(changed);
+        QCOMPARE(value, "foo"_l1);
+
+        changed = false;
+        const QString copy = QString("foo"_l1);
+        setChangedInterned(value, copy, changed);
+        QVERIFY(!changed);
+        QCOMPARE(value.constData(), internString(copy).constData());
+
+        setChangedInterned(value, "bar"_l1, changed);
+        QVERIFY(changed);
+        QCOMPARE(value, "bar"_l1);
+    }
+};
+
+QTEST_MAIN(StringPoolTest)
+
+#include "stringpool_test.moc"
@@ -6,71 +6,28 @@
 
 #include <algorithm>
 #include <array>
+#include <list>
 #include <stdexcept>
+#include <unordered_map>
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QLocale>
 
+#include "fileutils.h"
 #include "jsonutils.h"
 #include "itemlistupdater.h"
 #include "log.h"
 #include "pathutils.h"
 #include "rpc.h"
 #include "stdutils.h"
+#include "stringpool.h"
 
 namespace libtremotesf {
     using namespace impl;
 
-    enum class TorrentData::UpdateKey {
-        Id,
-        HashString,
-        AddedDate,
-        Name,
-        MagnetLink,
-        QueuePosition,
-        TotalSize,
-        CompletedSize,
-        LeftUntilDone,
-        SizeWhenDone,
-        PercentDone,
-        RecheckProgress,
-        Eta,
-        MetadataPercentComplete,
-        DownloadSpeed,
-        UploadSpeed,
-        DownloadSpeedLimited,
-        DownloadSpeedLimit,
-        UploadSpeedLimited,
-        UploadSpeedLimit,
-        TotalDownloaded,
-        TotalUploaded,
-        Ratio,
-        RatioLimitMode,
-        RatioLimit,
-        PeersSendingToUsCount,
-        PeersGettingFromUsCount,
-        WebSeeders,
-        WebSeedersSendingToUsCount,
-        Status,
-        Error,
-        ErrorString,
-        ActivityDate,
-        DoneDate,
-        PeersLimit,
-        HonorSessionLimits,
-        BandwidthPriority,
-        IdleSeedingLimitMode,
-        IdleSeedingLimit,
-        DownloadDirectory,
-        Creator,
-        CreationDate,
-        Comment,
-        TrackerStats,
-        Count
-    };
-
     namespace {
         constexpr QLatin1String updateKeyString(TorrentData::UpdateKey key) {
             switch (key) {
@@ -179,7 +136,7 @@ namespace libtremotesf {
             }();
             const auto foundKey = mapping.find(stringKey);
             if (foundKey == mapping.end()) {
-                logWarning("Unknown torrent field '{}'", stringKey);
+                logCWarningDeduplicated(jsonLog, stringKey, "Unknown torrent field '{}'", stringKey);
                 return {};
             }
             return static_cast<TorrentData::UpdateKey>(foundKey->second);
@@ -193,6 +150,18 @@ namespace libtremotesf {
         constexpr auto normalPriorityKey = "priority-normal"_l1;
         constexpr auto highPriorityKey = "priority-high"_l1;
 
+        QLatin1String filesPriorityKey(TorrentFile::Priority priority) {
+            switch (priority) {
+            case TorrentFile::Priority::Low:
+                return lowPriorityKey;
+            case TorrentFile::Priority::Normal:
+                return normalPriorityKey;
+            case TorrentFile::Priority::High:
+                return highPriorityKey;
+            }
+            throw std::logic_error("Unknown TorrentFile::Priority value");
+        }
+
         constexpr auto addTrackerKey = "trackerAdd"_l1;
         constexpr auto replaceTrackerKey = "trackerReplace"_l1;
         constexpr auto removeTrackerKey = "trackerRemove"_l1;
@@ -226,16 +195,27 @@ namespace libtremotesf {
             EnumMapping(TorrentData::IdleSeedingLimitMode::Global, 0),
             EnumMapping(TorrentData::IdleSeedingLimitMode::Single, 1),
             EnumMapping(TorrentData::IdleSeedingLimitMode::Unlimited, 2)});
+
+        // Torrents are updated on the thread of their Rpc, and different Rpc instances may live on different threads
+        NormalizedPathsCache& downloadDirectoriesCache() {
+            thread_local NormalizedPathsCache cache{};
+            return cache;
+        }
     }
 
     int TorrentData::priorityToInt(Priority value) { return priorityMapper.toJsonConstant(value); }
 
-    bool TorrentData::update(const QJsonObject& object, bool firstTime, const Rpc* rpc) {
+    QDateTime TorrentData::addedDate() const { return dateTimeFromSecsSinceEpoch(addedDateSecs); }
+    QDateTime TorrentData::activityDate() const { return dateTimeFromSecsSinceEpoch(activityDateSecs); }
+    QDateTime TorrentData::doneDate() const { return dateTimeFromSecsSinceEpoch(doneDateSecs); }
+    QDateTime TorrentData::creationDate() const { return dateTimeFromSecsSinceEpoch(creationDateSecs); }
+
+    bool TorrentData::update(const QJsonObject& object, bool firstTime, const Rpc* rpc, UpdateKeySet* changedKeys) {
         bool changed = false;
         for (auto i = object.begin(), end = object.end(); i != end; ++i) {
             const auto key = mapUpdateKey(i.key());
             if (key.has_value()) {
-                updateProperty(*key, i.value(), changed, firstTime, rpc);
+                updateProperty(*key, i.value(), changed, changedKeys, firstTime, rpc);
             }
         }
         return changed;
@@ -245,19 +225,42 @@ namespace libtremotesf {
         std::span<const std::optional<TorrentData::UpdateKey>> keys,
         const QJsonArray& values,
         bool firstTime,
-        const Rpc* rpc
+        const Rpc* rpc,
+        UpdateKeySet* changedKeys
     ) {
         bool changed = false;
         const auto count = std::min(keys.size(), static_cast<size_t>(values.size()));
         for (size_t i = 0; i < count; ++i) {
             const auto key = keys[i];
             if (key.has_value()) {
-                updateProperty(*key, values[static_cast<QJsonArray::size_type>(i)], changed, firstTime, rpc);
+                updateProperty(
+                    *key,
+                    values[static_cast<QJsonArray::size_type>(i)],
+                    changed,
+                    changedKeys,
+                    firstTime,
+                    rpc
+                );
             }
         }
         return changed;
     }
 
+    void TorrentData::updateProperty(
+        UpdateKey key, const QJsonValue& value, bool& changed, UpdateKeySet* changedKeys, bool firstTime, const Rpc* rpc
+    ) {
+        if (!changedKeys) {
+            updateProperty(key, value, changed, firstTime, rpc);
+            return;
+        }
+        bool propertyChanged = false;
+        updateProperty(key, value, propertyChanged, firstTime, rpc);
+        if (propertyChanged) {
+            changed = true;
+            changedKeys->set(static_cast<size_t>(key));
+        }
+    }
+
     void TorrentData::updateProperty(
         TorrentData::UpdateKey intKey,
         const QJsonValue& value,
@@ -271,11 +274,15 @@ namespace libtremotesf {
             return;
         case TorrentData::UpdateKey::HashString:
             if (firstTime) {
-                hashString = value.toString();
+                if (const auto parsed = InfoHash::fromHexString(value.toString()); parsed.has_value()) {
+                    hash = *parsed;
+                } else {
+                    logCWarning(jsonLog, "Invalid torrent hash {}", value);
+                }
             }
             return;
         case TorrentData::UpdateKey::AddedDate:
-            return updateDateTime(addedDate, value, changed);
+            return updateDateTime(addedDateSecs, value, changed);
         case TorrentData::UpdateKey::Name:
             return setChanged(name, value.toString(), changed);
         case TorrentData::UpdateKey::MagnetLink:
@@ -342,11 +349,11 @@ namespace libtremotesf {
         case TorrentData::UpdateKey::Error:
             return setChanged(error, errorMapper.fromJsonValue(value, updateKeyString(key)), changed);
         case TorrentData::UpdateKey::ErrorString:
-            return setChanged(errorString, value.toString(), changed);
+            return setChangedInterned(errorString, value.toString(), changed);
         case TorrentData::UpdateKey::ActivityDate:
-            return updateDateTime(activityDate, value, changed);
+            return updateDateTime(activityDateSecs, value, changed);
         case TorrentData::UpdateKey::DoneDate:
-            return updateDateTime(doneDate, value, changed);
+            return updateDateTime(doneDateSecs, value, changed);
         case TorrentData::UpdateKey::PeersLimit:
             return setChanged(peersLimit, value.toInt(), changed);
         case TorrentData::UpdateKey::HonorSessionLimits:
@@ -362,44 +369,76 @@ namespace libtremotesf {
         case TorrentData::UpdateKey::IdleSeedingLimit:
             return setChanged(idleSeedingLimit, value.toInt(), changed);
         case TorrentData::UpdateKey::DownloadDirectory:
-            return setChanged(
+            return setChangedInterned(
                 downloadDirectory,
-                normalizePath(value.toString(), rpc->serverSettings()->data().pathOs),
+                downloadDirectoriesCache().normalizePath(value.toString(), rpc->serverSettings()->data().pathOs),
                 changed
             );
         case TorrentData::UpdateKey::Creator:
-            return setChanged(creator, value.toString(), changed);
+            return setChangedInterned(creator, value.toString(), changed);
         case TorrentData::UpdateKey::CreationDate:
-            return updateDateTime(creationDate, value, changed);
+            return updateDateTime(creationDateSecs, value, changed);
         case TorrentData::UpdateKey::Comment:
             return setChanged(comment, value.toString(), changed);
         case TorrentData::UpdateKey::TrackerStats: {
-            std::vector<Tracker> newTrackers{};
             const QJsonArray trackerJsons = value.toArray();
-            newTrackers.reserve(static_cast<size_t>(trackerJsons.size()));
-            int newTotalSeeders{};
-            int newTotalLeechers{};
+            std::vector<std::pair<int, QJsonObject>> newTrackerMaps{};
+            newTrackerMaps.reserve(static_cast<size_t>(trackerJsons.size()));
             for (const auto& i : trackerJsons) {
-                const QJsonObject trackerMap = i.toObject();
+                QJsonObject trackerMap = i.toObject();
                 const int trackerId = trackerMap.value("id"_l1).toInt();
-                const auto found = std::find_if(trackers.begin(), trackers.end(), [&](const auto& tracker) {
-                    return tracker.id() == trackerId;
-                });
-                if (found == trackers.end()) {
-                    newTrackers.emplace_back(trackerId, trackerMap);
-                    changed = true;
-                } else {
-                    if (found->update(trackerMap)) {
-                        changed = true;
+                newTrackerMaps.emplace_back(trackerId, std::move(trackerMap));
+            }
+
+            bool trackersChanged = false;
+            const bool sameTrackers = std::equal(
+                newTrackerMaps.begin(),
+                newTrackerMaps.end(),
+                trackers.begin(),
+                trackers.end(),
+                [](const auto& newTracker, const Tracker& tracker) { return newTracker.first == tracker.id(); }
+            );
+            if (sameTrackers) {
+                // Common case, update in place
+                for (size_t i = 0; i < trackers.size(); ++i) {
+                    if (trackers[i].update(newTrackerMaps[i].second)) {
+                        trackersChanged = true;
                     }
-                    newTrackers.push_back(std::move(*found));
                 }
-                newTotalSeeders += newTrackers.back().seeders();
-                newTotalLeechers += newTrackers.back().leechers();
+            } else {
+                std::unordered_map<int, size_t> oldTrackersIndexes{};
+                oldTrackersIndexes.reserve(trackers.size());
+                for (size_t i = 0; i < trackers.size(); ++i) {
+                    oldTrackersIndexes.emplace(trackers[i].id(), i);
+                }
+                std::vector<Tracker> newTrackers{};
+                newTrackers.reserve(newTrackerMaps.size());
+                for (const auto& [trackerId, trackerMap] : newTrackerMaps) {
+                    if (const auto found = oldTrackersIndexes.find(trackerId); found != oldTrackersIndexes.end()) {
+                        Tracker& tracker = trackers[found->second];
+                        tracker.update(trackerMap);
+                        newTrackers.push_back(std::move(tracker));
+                        // Guard against duplicate ids
+                        oldTrackersIndexes.erase(found);
+                    } else {
+                        newTrackers.emplace_back(trackerId, trackerMap);
+                    }
+                }
+                trackers = std::move(newTrackers);
+                trackersChanged = true;
+            }
+
+            if (trackersChanged) {
+                changed = true;
+                int newTotalSeeders{};
+                int newTotalLeechers{};
+                for (const auto& tracker : trackers) {
+                    newTotalSeeders += tracker.seeders();
+                    newTotalLeechers += tracker.leechers();
+                }
+                setChanged(totalSeedersFromTrackersCount, newTotalSeeders, changed);
+                setChanged(totalLeechersFromTrackersCount, newTotalLeechers, changed);
             }
-            trackers = std::move(newTrackers);
-            setChanged(totalSeedersFromTrackersCount, newTotalSeeders, changed);
-            setChanged(totalLeechersFromTrackersCount, newTotalLeechers, changed);
             return;
         }
         case TorrentData::UpdateKey::Count:
@@ -408,32 +447,53 @@ namespace libtremotesf {
         throw std::logic_error(fmt::format("Can't update key {}", static_cast<int>(intKey)));
     }
 
-    Torrent::Torrent(int id, const QJsonObject& object, Rpc* rpc, QObject* parent) : QObject(parent), mRpc(rpc) {
+    Torrent::Torrent(int id, const QJsonObject& object, Rpc* rpc) : mRpc(rpc) {
         mData.id = id;
         [[maybe_unused]] const bool changed = mData.update(object, true, rpc);
     }
 
     Torrent::Torrent(
-        int id,
-        std::span<const std::optional<TorrentData::UpdateKey>> keys,
-        const QJsonArray& values,
-        Rpc* rpc,
-        QObject* parent
+        int id, std::span<const std::optional<TorrentData::UpdateKey>> keys, const QJsonArray& values, Rpc* rpc
     )
-        : QObject(parent), mRpc(rpc) {
+        : mRpc(rpc) {
         mData.id = id;
         [[maybe_unused]] const bool changed = mData.update(keys, values, true, rpc);
     }
 
+    Torrent::~Torrent() = default;
+
+    std::shared_ptr<const TorrentData> Torrent::dataSnapshot() {
+        if (!mDataSnapshot) {
+            mDataSnapshot = std::make_shared<const TorrentData>(mData);
+        }
+        return mDataSnapshot;
+    }
+
+    TorrentNotifier* Torrent::notifier() {
+        if (!mNotifier) {
+            mNotifier = std::make_unique<TorrentNotifier>(this);
+        }
+        return mNotifier.get();
+    }
+
     QJsonArray Torrent::updateFields() {
         QJsonArray fields{};
         for (int i = 0; i < static_cast<int>(TorrentData::UpdateKey::Count); ++i) {
             const auto key = static_cast<TorrentData::UpdateKey>(i);
-            fields.push_back(updateKeyString(key));
+            // Requested separately, see shouldPollTrackers()
+            if (key != TorrentData::UpdateKey::TrackerStats) {
+                fields.push_back(updateKeyString(key));
+            }
         }
         return fields;
     }
 
+    QJsonArray Torrent::trackersUpdateFields() {
+        return QJsonArray{
+            updateKeyString(TorrentData::UpdateKey::Id),
+            updateKeyString(TorrentData::UpdateKey::TrackerStats)};
+    }
+
     std::optional<int> Torrent::idFromJson(const QJsonObject& object) {
         const auto value = object.value(updateKeyString(TorrentData::UpdateKey::Id));
         if (value.isDouble()) {
@@ -456,26 +516,31 @@ namespace libtremotesf {
 
     void Torrent::setDownloadSpeedLimited(bool limited) {
         mData.downloadSpeedLimited = limited;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::DownloadSpeedLimited), limited);
     }
 
     void Torrent::setDownloadSpeedLimit(int limit) {
         mData.downloadSpeedLimit = limit;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::DownloadSpeedLimit), limit);
     }
 
     void Torrent::setUploadSpeedLimited(bool limited) {
         mData.uploadSpeedLimited = limited;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::UploadSpeedLimited), limited);
     }
 
     void Torrent::setUploadSpeedLimit(int limit) {
         mData.uploadSpeedLimit = limit;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::UploadSpeedLimit), limit);
     }
 
     void Torrent::setRatioLimitMode(TorrentData::RatioLimitMode mode) {
         mData.ratioLimitMode = mode;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(
             mData.id,
             updateKeyString(TorrentData::UpdateKey::RatioLimitMode),
@@ -485,21 +550,25 @@ namespace libtremotesf {
 
     void Torrent::setRatioLimit(double limit) {
         mData.ratioLimit = limit;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::RatioLimit), limit);
     }
 
     void Torrent::setPeersLimit(int limit) {
         mData.peersLimit = limit;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::PeersLimit), limit);
     }
 
     void Torrent::setHonorSessionLimits(bool honor) {
         mData.honorSessionLimits = honor;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::HonorSessionLimits), honor);
     }
 
     void Torrent::setBandwidthPriority(TorrentData::Priority priority) {
         mData.bandwidthPriority = priority;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(
             mData.id,
             updateKeyString(TorrentData::UpdateKey::BandwidthPriority),
@@ -509,6 +578,7 @@ namespace libtremotesf {
 
     void Torrent::setIdleSeedingLimitMode(TorrentData::IdleSeedingLimitMode mode) {
         mData.idleSeedingLimitMode = mode;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(
             mData.id,
             updateKeyString(TorrentData::UpdateKey::IdleSeedingLimitMode),
@@ -518,18 +588,22 @@ namespace libtremotesf {
 
     void Torrent::setIdleSeedingLimit(int limit) {
         mData.idleSeedingLimit = limit;
+        mDataSnapshot.reset();
         mRpc->setTorrentProperty(mData.id, updateKeyString(TorrentData::UpdateKey::IdleSeedingLimit), limit);
     }
 
     void Torrent::addTrackers(const QStringList& announceUrls) {
+        requestTrackersUpdate();
         mRpc->setTorrentProperty(mData.id, addTrackerKey, QJsonArray::fromStringList(announceUrls), true);
     }
 
     void Torrent::setTracker(int trackerId, const QString& announce) {
+        requestTrackersUpdate();
         mRpc->setTorrentProperty(mData.id, replaceTrackerKey, QJsonArray{trackerId, announce}, true);
     }
 
     void Torrent::removeTrackers(std::span<const int> ids) {
+        requestTrackersUpdate();
         mRpc->setTorrentProperty(mData.id, removeTrackerKey, toJsonArray(ids), true);
     }
 
@@ -537,66 +611,394 @@ namespace libtremotesf {
         if (enabled != mFilesEnabled) {
             mFilesEnabled = enabled;
             if (mFilesEnabled) {
-                mRpc->getTorrentsFiles(std::array{mData.id}, false);
+                markListsAccessed();
+                if (mListsEvicted) {
+                    reloadLists();
+                } else {
+                    mRpc->getTorrentsFiles(std::array{mData.id}, false);
+                }
             } else {
                 mFiles.clear();
+                mFilesStats.clear();
+                mNewFilesStats.clear();
+                mFilesTree.clear();
+                mFilesResidentBytes = 0;
             }
         }
     }
 
+    const std::vector<TorrentFile>& Torrent::files() const {
+        markListsAccessed();
+        return mFiles;
+    }
+
+    const TorrentFilesTree& Torrent::filesTree() const {
+        markListsAccessed();
+        return mFilesTree;
+    }
+
+    const TorrentFilesStats& Torrent::filesStats() const {
+        markListsAccessed();
+        return mFilesStats;
+    }
+
     void Torrent::setFilesWanted(std::span<const int> fileIds, bool wanted) {
         mRpc->setTorrentProperty(mData.id, wanted ? wantedFilesKey : unwantedFilesKey, toJsonArray(fileIds));
     }
 
     void Torrent::setFilesPriority(std::span<const int> fileIds, TorrentFile::Priority priority) {
-        QLatin1String propertyName;
-        switch (priority) {
-        case TorrentFile::Priority::Low:
-            propertyName = lowPriorityKey;
-            break;
-        case TorrentFile::Priority::Normal:
-            propertyName = normalPriorityKey;
-            break;
-        case TorrentFile::Priority::High:
-            propertyName = highPriorityKey;
-            break;
+        mRpc->setTorrentProperty(mData.id, filesPriorityKey(priority), toJsonArray(fileIds));
+    }
+
+    void Torrent::setSubtreeWanted(int node, bool wanted) {
+        markListsAccessed();
+        const auto fileIds = subtreeFileIdsForRequest(node);
+        if (!fileIds.has_value()) {
+            return;
+        }
+        // Request is sent even if local stats are already the same since they may be outdated
+        mRpc->setTorrentProperty(mData.id, wanted ? wantedFilesKey : unwantedFilesKey, toJsonArray(*fileIds));
+        applySubtreeFilesStats(node, [wanted](TorrentFileStats& stats) { stats.wanted = wanted; });
+    }
+
+    void Torrent::setSubtreePriority(int node, TorrentFile::Priority priority) {
+        markListsAccessed();
+        const auto fileIds = subtreeFileIdsForRequest(node);
+        if (!fileIds.has_value()) {
+            return;
+        }
+        mRpc->setTorrentProperty(mData.id, filesPriorityKey(priority), toJsonArray(*fileIds));
+        applySubtreeFilesStats(node, [priority](TorrentFileStats& stats) { stats.priority = priority; });
+    }
+
+    std::optional<std::vector<int>> Torrent::subtreeFileIdsForRequest(int node) const {
+        auto fileIds = mFilesTree.fileIds(node);
+        if (fileIds.empty()) {
+            return std::nullopt;
+        }
+        // Empty array means all files of torrent
+        if (fileIds.size() == mFiles.size()) {
+            return std::vector<int>{};
+        }
+        return fileIds;
+    }
+
+    template<typename Change>
+    void Torrent::applySubtreeFilesStats(int node, Change&& change) {
+        std::vector<int> changed{};
+        for (const int fileId : mFilesTree.fileIds(node)) {
+            const auto index = static_cast<size_t>(fileId);
+            if (index >= mFilesStats.size()) {
+                continue;
+            }
+            const auto oldStats = mFilesStats.at(index);
+            auto newStats = oldStats;
+            change(newStats);
+            if (newStats != oldStats) {
+                mFilesStats.set(index, newStats);
+                mFilesTree.updateFile(fileId, oldStats, newStats);
+                changed.push_back(fileId);
+            }
         }
-        mRpc->setTorrentProperty(mData.id, propertyName, toJsonArray(fileIds));
+        if (changed.empty()) {
+            return;
+        }
+        if (mNotifier) {
+            emit mNotifier->filesUpdated(changed);
+        }
+        emit mRpc->torrentFilesUpdated(this, changed);
     }
 
     void Torrent::renameFile(const QString& path, const QString& newName) {
         mRpc->renameTorrentFile(mData.id, path, newName);
     }
 
+    bool Torrent::applyFileRename(const QString& path, const QString& newName) {
+        // Renaming top-level file or directory renames torrent itself
+        const bool nameChanged = (path == mData.name && newName != mData.name);
+        if (nameChanged) {
+            mData.name = newName;
+            mDataSnapshot.reset();
+            if (mNotifier) {
+                emit mNotifier->changed();
+            }
+        }
+
+        if (mFilesTree.isEmpty()) {
+            // Files are not loaded, nothing to patch
+            return nameChanged;
+        }
+        const int node = mFilesTree.findNode(path);
+        if (node == -1) {
+            logCWarning(torrentsLog, "Renamed path '{}' is not found in files of torrent {}", path, *this);
+            return nameChanged;
+        }
+        mFilesTree.renameNode(node, newName);
+        const auto changed = mFilesTree.fileIds(node);
+        if (mNotifier) {
+            emit mNotifier->filesUpdated(changed);
+        }
+        emit mRpc->torrentFilesUpdated(this, changed);
+        return nameChanged;
+    }
+
     void Torrent::setPeersEnabled(bool enabled) {
         if (enabled != mPeersEnabled) {
             mPeersEnabled = enabled;
             if (mPeersEnabled) {
-                mRpc->getTorrentsPeers(std::array{mData.id}, false);
+                markListsAccessed();
+                if (mListsEvicted) {
+                    reloadLists();
+                } else {
+                    mRpc->getTorrentsPeers(std::array{mData.id}, false);
+                }
             } else {
                 mPeers.clear();
+                mPeersResidentBytes = 0;
+            }
+        }
+    }
+
+    const std::vector<Peer>& Torrent::peers() const {
+        markListsAccessed();
+        return mPeers;
+    }
+
+    bool Torrent::shouldPollTrackers(qint64 currentTimeSecs) {
+        const auto isDue = [&](Tracker::Status status, qint64 nextTimeSecs) {
+            switch (status) {
+            case Tracker::Status::QueuedForUpdate:
+            case Tracker::Status::Updating:
+                return true;
+            case Tracker::Status::WaitingForUpdate:
+                return nextTimeSecs > 0 && nextTimeSecs <= currentTimeSecs;
+            case Tracker::Status::Inactive:
+                return false;
             }
+            return false;
+        };
+        // Server's clock may be ahead of ours, so don't rely only on announce and scrape times
+        bool poll = mTrackersUpdateRequested || mData.status != mStatusOnLastTrackersPoll ||
+                    mUpdatesSinceTrackersPoll + 1 >= maximumUpdatesWithoutTrackersPoll;
+        if (!poll) {
+            poll = std::any_of(mData.trackers.begin(), mData.trackers.end(), [&](const Tracker& tracker) {
+                return isDue(tracker.status(), tracker.nextUpdateTimeSecs()) ||
+                       isDue(tracker.scrapeStatus(), tracker.nextScrapeTimeSecs());
+            });
         }
+        if (poll) {
+            mTrackersUpdateRequested = false;
+            mStatusOnLastTrackersPoll = mData.status;
+            mUpdatesSinceTrackersPoll = 0;
+        } else {
+            ++mUpdatesSinceTrackersPoll;
+        }
+        return poll;
     }
 
-    bool Torrent::update(const QJsonObject& object) {
-        const bool c = mData.update(object, false, mRpc);
-        emit updated();
-        if (c) {
-            emit changed();
+    bool Torrent::shouldPollPeers(int idlePollingInterval) {
+        if (!mPeersEnabled || mListsEvicted) {
+            return false;
         }
-        return c;
+        bool poll = true;
+        if (mPeersPolling == PeersPolling::ActivityAware) {
+            if (mData.status == TorrentData::Status::Paused) {
+                // Poll once more after torrent is paused so that its peers are removed
+                poll = !mPeers.empty();
+            } else if (mData.isDownloadingStalled() && mData.isSeedingStalled()) {
+                poll = mUpdatesSincePeersPoll + 1 >= idlePollingInterval;
+            }
+        }
+        if (poll) {
+            mUpdatesSincePeersPoll = 0;
+        } else {
+            ++mUpdatesSincePeersPoll;
+        }
+        return poll;
     }
 
-    bool Torrent::update(std::span<const std::optional<TorrentData::UpdateKey>> keys, const QJsonArray& values) {
-        const bool c = mData.update(keys, values, false, mRpc);
-        emit updated();
-        if (c) {
-            emit changed();
+    size_t Torrent::listsResidentBytes() const { return mFilesResidentBytes + mPeersResidentBytes; }
+
+    void Torrent::evictLists() {
+        if ((!mFilesEnabled && !mPeersEnabled) || listsResidentBytes() == 0) {
+            return;
+        }
+        mListsEvicted = true;
+        mListsReloadRequested = false;
+        // Handlers of signals below may read lists, that must not be treated as access
+        mEvictingLists = true;
+        mFiles = {};
+        mFilesStats = {};
+        mNewFilesStats = {};
+        mFilesTree = {};
+        mFilesResidentBytes = 0;
+        const auto peersCount = static_cast<int>(mPeers.size());
+        mPeers = {};
+        mPeersResidentBytes = 0;
+        if (peersCount != 0) {
+            const std::vector<std::pair<int, int>> removedIndexRanges{{0, peersCount}};
+            if (mNotifier) {
+                emit mNotifier->peersUpdated(removedIndexRanges, {}, 0);
+            }
+            emit mRpc->torrentPeersUpdated(this, removedIndexRanges, {}, 0);
+        }
+        if (mNotifier) {
+            emit mNotifier->listsEvicted();
+        }
+        emit mRpc->torrentListsEvicted(this);
+        mEvictingLists = false;
+    }
+
+    void Torrent::reloadLists() {
+        if (!mListsEvicted) {
+            return;
+        }
+        mListsEvicted = false;
+        mListsReloadRequested = false;
+        mListsLastAccessTime = std::chrono::steady_clock::now();
+        if (mFilesEnabled) {
+            mRpc->getTorrentsFiles(std::array{mData.id}, false);
+        }
+        if (mPeersEnabled) {
+            mRpc->getTorrentsPeers(std::array{mData.id}, false);
         }
+    }
+
+    bool Torrent::takeListsReloadRequest() {
+        if (!mListsEvicted || !mListsReloadRequested) {
+            return false;
+        }
+        mListsEvicted = false;
+        mListsReloadRequested = false;
+        return true;
+    }
+
+    void Torrent::markListsAccessed() const {
+        if (mEvictingLists) {
+            return;
+        }
+        mListsLastAccessTime = std::chrono::steady_clock::now();
+        if (mListsEvicted) {
+            mListsReloadRequested = true;
+        }
+    }
+
+    bool Torrent::update(const QJsonObject& object, TorrentData::UpdateKeySet* changedKeys) {
+        const bool c = mData.update(object, false, mRpc, changedKeys);
+        onUpdated(c);
         return c;
     }
 
+    bool Torrent::update(
+        std::span<const std::optional<TorrentData::UpdateKey>> keys,
+        const QJsonArray& values,
+        TorrentData::UpdateKeySet* changedKeys
+    ) {
+        const bool c = mData.update(keys, values, false, mRpc, changedKeys);
+        onUpdated(c);
+        return c;
+    }
+
+    void Torrent::setSpeedHistoryEnabled(bool enabled) {
+        if (!enabled) {
+            mSpeedHistory.reset();
+        } else if (!mSpeedHistory) {
+            mSpeedHistory = std::make_unique<SpeedHistory>();
+        }
+    }
+
+    void Torrent::recordSpeedHistory(qint64 timeSecs) {
+        if (mSpeedHistory) {
+            mSpeedHistory->append(timeSecs, mData.downloadSpeed, mData.uploadSpeed);
+        }
+    }
+
+    void Torrent::setTransferStatsEnabled(bool enabled) {
+        mTransferStatsEnabled = enabled;
+        if (!enabled) {
+            mTransferStats.reset();
+        }
+        mTransferStatsOpenFailed = false;
+        mLastRecordedTotals.reset();
+    }
+
+    void Torrent::closeTransferStats() {
+        mTransferStats.reset();
+        mTransferStatsOpenFailed = false;
+        mLastRecordedTotals.reset();
+    }
+
+    const TransferStatsStore* Torrent::transferStats() {
+        if (!openTransferStats()) {
+            return nullptr;
+        }
+        // Don't close it right away if torrent is idle
+        mTransferStatsIdleUpdates = 0;
+        return mTransferStats.get();
+    }
+
+    bool Torrent::openTransferStats() {
+        if (mTransferStats) {
+            return true;
+        }
+        if (!mTransferStatsEnabled || mTransferStatsOpenFailed) {
+            return false;
+        }
+        const auto& directory = mRpc->transferStatsDirectory();
+        // Store is named after info hash, torrents without it can't have one
+        if (directory.isEmpty() || mData.hash.isEmpty()) {
+            return false;
+        }
+        try {
+            mTransferStats = std::make_unique<TransferStatsStore>(QDir(directory).filePath(mData.hash.toString()));
+        } catch (const QFileError& e) {
+            // Retried when directory changes or when recording is enabled again
+            mTransferStatsOpenFailed = true;
+            logCWarningDeduplicated(
+                rpcLog,
+                directory,
+                "Failed to open transfer stats of torrent {} in {}: {}",
+                mData.name,
+                directory,
+                e.what()
+            );
+            return false;
+        }
+        return true;
+    }
+
+    void Torrent::recordTransferStats(qint64 timeSecs) {
+        if (!mTransferStatsEnabled || mTransferStatsOpenFailed) {
+            return;
+        }
+        const std::pair totals{mData.totalDownloaded, mData.totalUploaded};
+        if (totals == mLastRecordedTotals) {
+            // Last record already has these totals
+            if (mTransferStats && ++mTransferStatsIdleUpdates >= transferStatsIdleUpdates) {
+                mTransferStats.reset();
+            }
+            return;
+        }
+        if (!openTransferStats()) {
+            return;
+        }
+        mTransferStats->append(timeSecs, totals.first, totals.second);
+        mLastRecordedTotals = totals;
+        mTransferStatsIdleUpdates = 0;
+    }
+
+    void Torrent::onUpdated(bool changed) {
+        if (changed) {
+            mDataSnapshot.reset();
+        }
+        if (mNotifier) {
+            emit mNotifier->updated();
+            if (changed) {
+                emit mNotifier->changed();
+            }
+        }
+    }
+
     void Torrent::updateFiles(const QJsonObject& torrentMap) {
         std::vector<int> changed{};
 
@@ -605,38 +1007,63 @@ namespace libtremotesf {
             if (mFiles.empty()) {
                 const QJsonArray fileJsons = torrentMap.value("files"_l1).toArray();
                 if (fileJsons.size() == fileStats.size()) {
+                    mFilesStats.decode(fileStats);
                     const auto count = fileJsons.size();
                     mFiles.reserve(static_cast<size_t>(count));
                     changed.reserve(static_cast<size_t>(count));
                     for (QJsonArray::size_type i = 0; i < count; ++i) {
-                        mFiles.emplace_back(i, fileJsons[i].toObject(), fileStats[i].toObject());
+                        mFiles.emplace_back(
+                            i,
+                            fileJsons[i].toObject(),
+                            mFilesStats.at(static_cast<size_t>(i)),
+                            mFilesTree
+                        );
                         changed.push_back(static_cast<int>(i));
                     }
+                    mFilesTree.finishAdding();
+                    updateFilesResidentBytes();
                 } else {
-                    logWarning("fileStats and files arrays have different sizes for torrent {}", *this);
+                    logCWarningDeduplicated(
+                        torrentsLog,
+                        mData.hash.toString(),
+                        "fileStats and files arrays have different sizes for torrent {}",
+                        *this
+                    );
                 }
             } else {
-                if (static_cast<size_t>(fileStats.size()) == mFiles.size()) {
-                    for (QJsonArray::size_type i = 0, max = fileStats.size(); i < max; ++i) {
-                        TorrentFile& file = mFiles[static_cast<size_t>(i)];
-                        if (file.update(fileStats[i].toObject())) {
-                            changed.push_back(static_cast<int>(i));
-                        }
+                if (static_cast<size_t>(fileStats.size()) == mFilesStats.size()) {
+                    mNewFilesStats.decode(fileStats);
+                    mFilesStats.findChanged(mNewFilesStats, changed);
+                    for (const int index : changed) {
+                        const auto i = static_cast<size_t>(index);
+                        mFilesTree.updateFile(index, mFilesStats.at(i), mNewFilesStats.at(i));
                     }
+                    // mNewFilesStats now contains old stats and will be overwritten on next update
+                    std::swap(mFilesStats, mNewFilesStats);
+                    updateFilesResidentBytes();
                 } else {
-                    logWarning("fileStats array has different size than in previous update for torrent {}", *this);
+                    logCWarningDeduplicated(
+                        torrentsLog,
+                        mData.hash.toString(),
+                        "fileStats array has different size than in previous update for torrent {}",
+                        *this
+                    );
                 }
             }
         }
 
-        emit filesUpdated(changed);
+        if (mNotifier) {
+            emit mNotifier->filesUpdated(changed);
+        }
         emit mRpc->torrentFilesUpdated(this, changed);
     }
 
     namespace {
-        using NewPeer = std::pair<QJsonObject, QString>;
+        using NewPeer = std::pair<QJsonObject, PeerEndpoint>;
+        // List so that matched peers can be erased without invalidating iterators in index
+        using NewPeers = std::list<NewPeer>;
 
-        class PeersListUpdater final : public ItemListUpdater<Peer, std::vector<NewPeer>> {
+        class PeersListUpdater final : public ItemListUpdater<Peer, NewPeers> {
 
         public:
             PeersListUpdater() = default;
@@ -645,14 +1072,25 @@ namespace libtremotesf {
             std::vector<std::pair<int, int>> changedIndexRanges{};
             int addedCount{};
 
+            void update(std::vector<Peer>& items, NewPeers&& newPeers) override {
+                mNewPeersByEndpoint.clear();
+                mNewPeersByEndpoint.reserve(newPeers.size());
+                for (auto i = newPeers.begin(), end = newPeers.end(); i != end; ++i) {
+                    mNewPeersByEndpoint.emplace(i->second, i);
+                }
+                ItemListUpdater::update(items, std::move(newPeers));
+            }
+
         protected:
-            std::vector<NewPeer>::iterator
-            findNewItemForItem(std::vector<NewPeer>& newPeers, const Peer& peer) override {
-                const auto& address = peer.address;
-                return std::find_if(newPeers.begin(), newPeers.end(), [address](const auto& newPeer) {
-                    const auto& [json, newPeerAddress] = newPeer;
-                    return newPeerAddress == address;
-                });
+            NewPeers::iterator findNewItemForItem(NewPeers& newPeers, const Peer& peer) override {
+                const auto found = mNewPeersByEndpoint.find(peer.endpoint);
+                if (found == mNewPeersByEndpoint.end()) {
+                    return newPeers.end();
+                }
+                const auto newPeer = found->second;
+                // Matched peer is erased from list by ItemListUpdater
+                mNewPeersByEndpoint.erase(found);
+                return newPeer;
             }
 
             void onAboutToRemoveItems(size_t, size_t) override{};
@@ -662,7 +1100,7 @@ namespace libtremotesf {
             }
 
             bool updateItem(Peer& peer, NewPeer&& newPeer) override {
-                const auto& [json, address] = newPeer;
+                const auto& [json, endpoint] = newPeer;
                 return peer.update(json);
             }
 
@@ -671,38 +1109,60 @@ namespace libtremotesf {
             }
 
             Peer createItemFromNewItem(NewPeer&& newPeer) override {
-                auto& [json, address] = newPeer;
-                return Peer(std::move(address), json);
+                const auto& [json, endpoint] = newPeer;
+                return Peer(endpoint, json);
             }
 
             void onAboutToAddItems(size_t) override {}
 
             void onAddedItems(size_t count) override { addedCount = static_cast<int>(count); };
+
+        private:
+            // Keyed by address and port: Transmission reports each peer connection separately,
+            // and several peers (e.g. behind the same NAT) may share an address
+            std::unordered_map<PeerEndpoint, NewPeers::iterator> mNewPeersByEndpoint{};
         };
     }
 
+    void Torrent::updateFilesResidentBytes() {
+        mFilesResidentBytes = mFiles.capacity() * sizeof(TorrentFile) + mFilesStats.memoryUsage() +
+                              mNewFilesStats.memoryUsage() + mFilesTree.memoryUsage();
+    }
+
     void Torrent::updatePeers(const QJsonObject& torrentMap) {
-        std::vector<NewPeer> newPeers;
+        NewPeers newPeers;
         {
             const QJsonArray peers(torrentMap.value("peers"_l1).toArray());
-            newPeers.reserve(static_cast<size_t>(peers.size()));
             for (const auto& i : peers) {
                 QJsonObject json = i.toObject();
-                QString address(json.value(Peer::addressKey).toString());
-                newPeers.emplace_back(std::move(json), std::move(address));
+                auto endpoint = PeerEndpoint::fromJson(json);
+                newPeers.emplace_back(std::move(json), std::move(endpoint));
             }
         }
 
         PeersListUpdater updater{};
         updater.update(mPeers, std::move(newPeers));
+        updatePeersResidentBytes();
 
-        emit peersUpdated(updater.removedIndexRanges, updater.changedIndexRanges, updater.addedCount);
+        if (mNotifier) {
+            emit mNotifier->peersUpdated(updater.removedIndexRanges, updater.changedIndexRanges, updater.addedCount);
+        }
         emit mRpc
             ->torrentPeersUpdated(this, updater.removedIndexRanges, updater.changedIndexRanges, updater.addedCount);
     }
 
+    void Torrent::updatePeersResidentBytes() {
+        mPeersResidentBytes = mPeers.capacity() * sizeof(Peer);
+        for (const auto& peer : mPeers) {
+            const auto stringsSize =
+                peer.client.capacity() + peer.unknownFlags.capacity() + peer.endpoint.unparsedAddress.capacity();
+            mPeersResidentBytes += static_cast<size_t>(stringsSize) * sizeof(QChar);
+        }
+    }
+
     void Torrent::checkSingleFile(const QJsonObject& torrentMap) {
         mData.singleFile = (torrentMap.value(prioritiesKey).toArray().size() == 1);
+        mDataSnapshot.reset();
     }
 }
 
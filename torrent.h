@@ -5,6 +5,9 @@
 #ifndef LIBTREMOTESF_TORRENT_H
 #define LIBTREMOTESF_TORRENT_H
 
+#include <bitset>
+#include <chrono>
+#include <memory>
 #include <optional>
 #include <span>
 #include <vector>
@@ -14,9 +17,13 @@
 #include <QObject>
 
 #include "formatters.h"
+#include "infohash.h"
 #include "peer.h"
+#include "speedhistory.h"
 #include "torrentfile.h"
+#include "torrentfilestree.h"
 #include "tracker.h"
+#include "transferstatsstore.h"
 
 class QJsonObject;
 
@@ -50,14 +57,71 @@ namespace libtremotesf {
         enum class IdleSeedingLimitMode { Global, Single, Unlimited };
         Q_ENUM(IdleSeedingLimitMode)
 
-        [[nodiscard]] bool update(const QJsonObject& object, bool firstTime, const Rpc* rpc);
+        enum class UpdateKey {
+            Id,
+            HashString,
+            AddedDate,
+            Name,
+            MagnetLink,
+            QueuePosition,
+            TotalSize,
+            CompletedSize,
+            LeftUntilDone,
+            SizeWhenDone,
+            PercentDone,
+            RecheckProgress,
+            Eta,
+            MetadataPercentComplete,
+            DownloadSpeed,
+            UploadSpeed,
+            DownloadSpeedLimited,
+            DownloadSpeedLimit,
+            UploadSpeedLimited,
+            UploadSpeedLimit,
+            TotalDownloaded,
+            TotalUploaded,
+            Ratio,
+            RatioLimitMode,
+            RatioLimit,
+            PeersSendingToUsCount,
+            PeersGettingFromUsCount,
+            WebSeeders,
+            WebSeedersSendingToUsCount,
+            Status,
+            Error,
+            ErrorString,
+            ActivityDate,
+            DoneDate,
+            PeersLimit,
+            HonorSessionLimits,
+            BandwidthPriority,
+            IdleSeedingLimitMode,
+            IdleSeedingLimit,
+            DownloadDirectory,
+            Creator,
+            CreationDate,
+            Comment,
+            TrackerStats,
+            Count
+        };
+        using UpdateKeySet = std::bitset<static_cast<size_t>(UpdateKey::Count)>;
 
-        enum class UpdateKey;
-        [[nodiscard]] bool
-        update(std::span<const std::optional<UpdateKey>> keys, const QJsonArray& values, bool firstTime, const Rpc* rpc);
+        /**
+         * If changedKeys is not null, keys of changed properties are added to it
+         */
+        [[nodiscard]] bool update(
+            const QJsonObject& object, bool firstTime, const Rpc* rpc, UpdateKeySet* changedKeys = nullptr
+        );
+        [[nodiscard]] bool update(
+            std::span<const std::optional<UpdateKey>> keys,
+            const QJsonArray& values,
+            bool firstTime,
+            const Rpc* rpc,
+            UpdateKeySet* changedKeys = nullptr
+        );
 
         int id{};
-        QString hashString{};
+        InfoHash hash{};
         QString name{};
         QString magnetLink{};
 
@@ -101,16 +165,17 @@ namespace libtremotesf {
 
         int peersLimit{};
 
-        QDateTime addedDate{{}, {}, Qt::UTC};
-        QDateTime activityDate{{}, {}, Qt::UTC};
-        QDateTime doneDate{{}, {}, Qt::UTC};
+        // Seconds since epoch, or 0 if unknown
+        qint64 addedDateSecs{};
+        qint64 activityDateSecs{};
+        qint64 doneDateSecs{};
 
         IdleSeedingLimitMode idleSeedingLimitMode{};
         int idleSeedingLimit{};
         QString downloadDirectory{};
         QString comment{};
         QString creator{};
-        QDateTime creationDate{{}, {}, Qt::UTC};
+        qint64 creationDateSecs{};
         Priority bandwidthPriority{};
         bool honorSessionLimits;
 
@@ -118,6 +183,11 @@ namespace libtremotesf {
 
         std::vector<Tracker> trackers{};
 
+        [[nodiscard]] QDateTime addedDate() const;
+        [[nodiscard]] QDateTime activityDate() const;
+        [[nodiscard]] QDateTime doneDate() const;
+        [[nodiscard]] QDateTime creationDate() const;
+
         [[nodiscard]] bool hasError() const { return error != Error::None; }
         [[nodiscard]] bool isFinished() const { return leftUntilDone == 0; }
         [[nodiscard]] bool isDownloadingStalled() const {
@@ -129,24 +199,68 @@ namespace libtremotesf {
         void updateProperty(
             TorrentData::UpdateKey key, const QJsonValue& value, bool& changed, bool firstTime, const Rpc* rpc
         );
+        void updateProperty(
+            UpdateKey key,
+            const QJsonValue& value,
+            bool& changed,
+            UpdateKeySet* changedKeys,
+            bool firstTime,
+            const Rpc* rpc
+        );
     };
 
-    class Torrent final : public QObject {
+    class Torrent;
+
+    /**
+     * Per-torrent signals
+     * Created on demand by Torrent::notifier(), since most torrents are only ever observed
+     * through Rpc signals and don't need a QObject of their own
+     */
+    class TorrentNotifier final : public QObject {
         Q_OBJECT
 
     public:
-        explicit Torrent(int id, const QJsonObject& object, Rpc* rpc, QObject* parent = nullptr);
+        explicit TorrentNotifier(Torrent* torrent) : mTorrent(torrent) {}
+
+        [[nodiscard]] Torrent* torrent() const { return mTorrent; }
+
+    private:
+        Torrent* mTorrent{};
+
+    signals:
+        void updated();
+        void changed();
+
+        void filesUpdated(const std::vector<int>& changedIndexes);
+        void peersUpdated(
+            const std::vector<std::pair<int, int>>& removedIndexRanges,
+            const std::vector<std::pair<int, int>>& changedIndexRanges,
+            int addedCount
+        );
+        void fileRenamed(const QString& filePath, const QString& newName);
+        /**
+         * Files and peers lists were released by Torrent::evictLists(). Files list is cleared
+         * without filesUpdated() (removal of peers is also reported with peersUpdated())
+         */
+        void listsEvicted();
+    };
+
+    class Torrent final {
+    public:
+        explicit Torrent(int id, const QJsonObject& object, Rpc* rpc);
         explicit Torrent(
-            int id,
-            std::span<const std::optional<TorrentData::UpdateKey>> keys,
-            const QJsonArray& values,
-            Rpc* rpc,
-            QObject* parent = nullptr
+            int id, std::span<const std::optional<TorrentData::UpdateKey>> keys, const QJsonArray& values, Rpc* rpc
         );
         // For testing only
         explicit Torrent() = default;
+        ~Torrent();
+        Q_DISABLE_COPY_MOVE(Torrent)
 
+        /**
+         * Fields of regular torrents update. trackerStats are not included, see shouldPollTrackers()
+         */
         [[nodiscard]] static QJsonArray updateFields();
+        [[nodiscard]] static QJsonArray trackersUpdateFields();
         [[nodiscard]] static std::optional<int> idFromJson(const QJsonObject& object);
         [[nodiscard]] static std::optional<QJsonArray::size_type>
         idKeyIndex(std::span<const std::optional<TorrentData::UpdateKey>> keys);
@@ -170,48 +284,200 @@ namespace libtremotesf {
         void removeTrackers(std::span<const int> trackerIds);
 
         [[nodiscard]] const TorrentData& data() const { return mData; };
+        /**
+         * Returns immutable copy of data() which is reused until torrent changes
+         */
+        [[nodiscard]] std::shared_ptr<const TorrentData> dataSnapshot();
 
         [[nodiscard]] bool isFilesEnabled() const { return mFilesEnabled; };
         void setFilesEnabled(bool enabled);
-        [[nodiscard]] const std::vector<TorrentFile>& files() const { return mFiles; };
+        /**
+         * Accessing files and peers lists marks them as recently used,
+         * and reloads them if they were evicted (see Rpc::setListsMemoryBudget())
+         */
+        [[nodiscard]] const std::vector<TorrentFile>& files() const;
+        /**
+         * Directory tree of files(), empty if files are not loaded yet
+         */
+        [[nodiscard]] const TorrentFilesTree& filesTree() const;
+        /**
+         * Completed size, priority and wanted state of files(), indexed by file id
+         */
+        [[nodiscard]] const TorrentFilesStats& filesStats() const;
+        [[nodiscard]] bool isFilesLoaded() const { return !mFiles.empty(); }
 
         void setFilesWanted(std::span<const int> fileIds, bool wanted);
         void setFilesPriority(std::span<const int> fileIds, TorrentFile::Priority priority);
+        /**
+         * Set wanted state or priority of all files in subtree of node of filesTree()
+         * filesStats() and filesTree() are updated immediately, without waiting for next update
+         */
+        void setSubtreeWanted(int node, bool wanted);
+        void setSubtreePriority(int node, TorrentFile::Priority priority);
         void renameFile(const QString& path, const QString& newName);
+        /**
+         * Applies result of successful rename to filesTree() and emits filesUpdated() for files in renamed subtree
+         * If top-level file or directory was renamed, also changes name of torrent and emits changed()
+         * Returns true if name of torrent was changed
+         */
+        bool applyFileRename(const QString& path, const QString& newName);
 
         [[nodiscard]] bool isPeersEnabled() const { return mPeersEnabled; };
         void setPeersEnabled(bool enabled);
-        [[nodiscard]] const std::vector<Peer>& peers() const { return mPeers; };
-
-        [[nodiscard]] bool update(const QJsonObject& object);
-        [[nodiscard]] bool
-        update(std::span<const std::optional<TorrentData::UpdateKey>> keys, const QJsonArray& values);
+        [[nodiscard]] const std::vector<Peer>& peers() const;
+
+        /**
+         * In ActivityAware mode (default), peers of torrents that exchange data with peers are polled on each update,
+         * peers of idle torrents once in Rpc::idlePeersPollingInterval() updates, and peers of paused torrents
+         * are not polled at all
+         */
+        enum class PeersPolling { EveryUpdate, ActivityAware };
+        [[nodiscard]] PeersPolling peersPolling() const { return mPeersPolling; }
+        void setPeersPolling(PeersPolling polling) { mPeersPolling = polling; }
+        /**
+         * Called by Rpc on each update. Returns true if peers should be requested
+         */
+        [[nodiscard]] bool shouldPollPeers(int idlePollingInterval);
+
+        /**
+         * Called by Rpc on each update. Returns true if trackerStats should be requested, which happens
+         * when trackers are not loaded yet, announce or scrape is due or in progress, torrent's status has changed,
+         * requestTrackersUpdate() was called or trackers were not requested for maximumUpdatesWithoutTrackersPoll
+         * updates
+         */
+        [[nodiscard]] bool shouldPollTrackers(qint64 currentTimeSecs);
+        static constexpr int maximumUpdatesWithoutTrackersPoll = 60;
+        /**
+         * Requests trackerStats on next update
+         */
+        void requestTrackersUpdate() { mTrackersUpdateRequested = true; }
+
+        /**
+         * Approximate memory used by files and peers lists: their arrays, files tree
+         * and payloads of peers' strings. Client names are interned and shared between peers,
+         * but are counted for each of them. Allocator and QString headers overhead is not included
+         */
+        [[nodiscard]] size_t listsResidentBytes() const;
+        [[nodiscard]] std::chrono::steady_clock::time_point listsLastAccessTime() const { return mListsLastAccessTime; }
+        [[nodiscard]] bool isListsEvicted() const { return mListsEvicted; }
+        /**
+         * Releases files and peers lists and stops polling them until they are accessed
+         * Access only requests reload, lists are loaded again on next update (or with reloadLists())
+         */
+        void evictLists();
+        /**
+         * Immediately requests evicted lists from server
+         */
+        void reloadLists();
+        /**
+         * Called by Rpc on update. Returns true if evicted lists were accessed since eviction
+         * and should be polled again
+         */
+        [[nodiscard]] bool takeListsReloadRequest();
+
+        /**
+         * Speed history is not recorded by default
+         * Returns nullptr if it is disabled
+         */
+        [[nodiscard]] const SpeedHistory* speedHistory() const { return mSpeedHistory.get(); }
+        void setSpeedHistoryEnabled(bool enabled);
+        /**
+         * Called by Rpc after each torrents update
+         */
+        void recordSpeedHistory(qint64 timeSecs);
+
+        /**
+         * Transfer totals are not persisted by default. When enabled, they are recorded
+         * in Rpc::transferStatsDirectory() after each update when they change
+         * Store keeps two files open, so it is closed after transferStatsIdleUpdates updates without changes
+         * and reopened when needed
+         * Opens store if needed. Returns nullptr if it is disabled or if it failed to open
+         */
+        [[nodiscard]] const TransferStatsStore* transferStats();
+        [[nodiscard]] bool isTransferStatsEnabled() const { return mTransferStatsEnabled; }
+        void setTransferStatsEnabled(bool enabled);
+        /**
+         * Called by Rpc after each torrents update
+         */
+        void recordTransferStats(qint64 timeSecs);
+        static constexpr int transferStatsIdleUpdates = 12;
+        /**
+         * Closes store, it will be reopened in current directory on next record
+         * Also allows to retry opening store after failure
+         */
+        void closeTransferStats();
+
+        [[nodiscard]] bool update(const QJsonObject& object, TorrentData::UpdateKeySet* changedKeys = nullptr);
+        [[nodiscard]] bool update(
+            std::span<const std::optional<TorrentData::UpdateKey>> keys,
+            const QJsonArray& values,
+            TorrentData::UpdateKeySet* changedKeys = nullptr
+        );
         void updateFiles(const QJsonObject& torrentMap);
         void updatePeers(const QJsonObject& torrentMap);
 
         void checkSingleFile(const QJsonObject& torrentMap);
 
+        /**
+         * Returns QObject that emits signals for this torrent, creating it if needed
+         */
+        [[nodiscard]] TorrentNotifier* notifier();
+        [[nodiscard]] TorrentNotifier* notifierIfCreated() const { return mNotifier.get(); }
+
     private:
+        /**
+         * Returns ids of all files in subtree of node to send to server (empty if it covers whole torrent),
+         * or nullopt if subtree has no files
+         */
+        [[nodiscard]] std::optional<std::vector<int>> subtreeFileIdsForRequest(int node) const;
+        /**
+         * Optimistically applies change to local stats of files in subtree of node and emits filesUpdated
+         */
+        template<typename Change>
+        void applySubtreeFilesStats(int node, Change&& change);
+        void updateFilesResidentBytes();
+        void updatePeersResidentBytes();
+        bool openTransferStats();
+
+        void markListsAccessed() const;
+        void onUpdated(bool changed);
+
         Rpc* mRpc{};
+        std::unique_ptr<TorrentNotifier> mNotifier{};
 
         TorrentData mData{};
+        std::shared_ptr<const TorrentData> mDataSnapshot{};
 
         std::vector<TorrentFile> mFiles{};
+        TorrentFilesStats mFilesStats{};
+        // Stats from latest response are decoded here and then swapped with mFilesStats,
+        // so that columns are not reallocated on each update
+        TorrentFilesStats mNewFilesStats{};
+        TorrentFilesTree mFilesTree{};
         bool mFilesEnabled{};
 
         std::vector<Peer> mPeers{};
         bool mPeersEnabled{};
-    signals:
-        void updated();
-        void changed();
-
-        void filesUpdated(const std::vector<int>& changedIndexes);
-        void peersUpdated(
-            const std::vector<std::pair<int, int>>& removedIndexRanges,
-            const std::vector<std::pair<int, int>>& changedIndexRanges,
-            int addedCount
-        );
-        void fileRenamed(const QString& filePath, const QString& newName);
+        PeersPolling mPeersPolling{PeersPolling::ActivityAware};
+        int mUpdatesSincePeersPoll{};
+
+        std::unique_ptr<SpeedHistory> mSpeedHistory{};
+        std::unique_ptr<TransferStatsStore> mTransferStats{};
+        bool mTransferStatsEnabled{};
+        bool mTransferStatsOpenFailed{};
+        std::optional<std::pair<qint64, qint64>> mLastRecordedTotals{};
+        int mTransferStatsIdleUpdates{};
+
+        bool mTrackersUpdateRequested{true};
+        std::optional<TorrentData::Status> mStatusOnLastTrackersPoll{};
+        int mUpdatesSinceTrackersPoll{};
+
+        size_t mFilesResidentBytes{};
+        size_t mPeersResidentBytes{};
+        mutable std::chrono::steady_clock::time_point mListsLastAccessTime{};
+        bool mListsEvicted{};
+        mutable bool mListsReloadRequested{};
+        bool mEvictingLists{};
     };
 }
 
@@ -4,12 +4,13 @@
 
 #include "torrentfile.h"
 
+#include <QJsonArray>
 #include <QJsonObject>
-#include <QStringList>
 
 #include "jsonutils.h"
 #include "literals.h"
 #include "stdutils.h"
+#include "torrentfilestree.h"
 
 namespace libtremotesf {
     using namespace impl;
@@ -20,24 +21,61 @@ namespace libtremotesf {
             EnumMapping(TorrentFile::Priority::High, 1)});
     }
 
-    TorrentFile::TorrentFile(int id, const QJsonObject& fileMap, const QJsonObject& fileStatsMap)
+    TorrentFile::TorrentFile(
+        int id, const QJsonObject& fileMap, const TorrentFileStats& stats, TorrentFilesTree& filesTree
+    )
         : id(id), size(toInt64(fileMap.value("length"_l1))) {
-        auto p = fileMap.value("name"_l1).toString().split(QLatin1Char('/'), Qt::SkipEmptyParts);
-        path.reserve(static_cast<size_t>(p.size()));
-        for (QString& part : p) {
-            path.push_back(std::move(part));
-        }
-        update(fileStatsMap);
+        node = filesTree.addFile(id, fileMap.value("name"_l1).toString(), size, stats);
     }
 
-    bool TorrentFile::update(const QJsonObject& fileStatsMap) {
-        bool changed = false;
+    QString TorrentFile::path(const TorrentFilesTree& filesTree) const { return filesTree.path(node); }
+
+    void TorrentFilesStats::clear() {
+        mCompletedSizes.clear();
+        mPriorities.clear();
+        mWanted.clear();
+    }
+
+    void TorrentFilesStats::set(size_t index, const TorrentFileStats& stats) {
+        mCompletedSizes[index] = stats.completedSize;
+        mPriorities[index] = stats.priority;
+        mWanted[index] = stats.wanted ? 1 : 0;
+    }
 
-        setChanged(completedSize, toInt64(fileStatsMap.value("bytesCompleted"_l1)), changed);
+    void TorrentFilesStats::decode(const QJsonArray& fileStats) {
+        const auto count = static_cast<size_t>(fileStats.size());
+        mCompletedSizes.resize(count);
+        mPriorities.resize(count);
+        mWanted.resize(count);
+
+        constexpr auto bytesCompletedKey = "bytesCompleted"_l1;
         constexpr auto priorityKey = "priority"_l1;
-        setChanged(priority, priorityMapper.fromJsonValue(fileStatsMap.value(priorityKey), priorityKey), changed);
-        setChanged(wanted, fileStatsMap.value("wanted"_l1).toBool(), changed);
+        constexpr auto wantedKey = "wanted"_l1;
+        size_t i = 0;
+        for (const auto& value : fileStats) {
+            const QJsonObject fileStatsMap = value.toObject();
+            mCompletedSizes[i] = toInt64(fileStatsMap.value(bytesCompletedKey));
+            mPriorities[i] = priorityMapper.fromJsonValue(fileStatsMap.value(priorityKey), priorityKey);
+            mWanted[i] = fileStatsMap.value(wantedKey).toBool() ? 1 : 0;
+            ++i;
+        }
+    }
 
-        return changed;
+    void TorrentFilesStats::findChanged(const TorrentFilesStats& other, std::vector<int>& changedIndexes) const {
+        const size_t count = size();
+        const qint64* completedSizes = mCompletedSizes.data();
+        const qint64* otherCompletedSizes = other.mCompletedSizes.data();
+        const TorrentFile::Priority* priorities = mPriorities.data();
+        const TorrentFile::Priority* otherPriorities = other.mPriorities.data();
+        const uint8_t* wanted = mWanted.data();
+        const uint8_t* otherWanted = other.mWanted.data();
+        for (size_t i = 0; i < count; ++i) {
+            // Non-short-circuiting operators so that there is only one branch per file
+            const bool changed = (completedSizes[i] != otherCompletedSizes[i]) |
+                                 (priorities[i] != otherPriorities[i]) | (wanted[i] != otherWanted[i]);
+            if (changed) {
+                changedIndexes.push_back(static_cast<int>(i));
+            }
+        }
     }
 }
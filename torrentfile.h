@@ -5,31 +5,101 @@
 #ifndef LIBTREMOTESF_TORRENTFILE_H
 #define LIBTREMOTESF_TORRENTFILE_H
 
+#include <cstdint>
+#include <span>
 #include <vector>
+
 #include <QObject>
 #include <QString>
 
 #include "formatters.h"
 
+class QJsonArray;
 class QJsonObject;
 
 namespace libtremotesf {
+    class TorrentFilesTree;
+
+    struct TorrentFileStats;
+
+    /**
+     * Immutable properties of file. Mutable ones are stored in TorrentFilesStats
+     */
     struct TorrentFile {
         Q_GADGET
     public:
         enum class Priority { Low, Normal, High };
         Q_ENUM(Priority)
 
-        explicit TorrentFile(int id, const QJsonObject& fileMap, const QJsonObject& fileStatsMap);
-        bool update(const QJsonObject& fileStatsMap);
+        /**
+         * Adds file's path to tree
+         */
+        explicit TorrentFile(
+            int id, const QJsonObject& fileMap, const TorrentFileStats& stats, TorrentFilesTree& filesTree
+        );
+
+        /**
+         * Returns '/'-separated path of file. Tree must be the one that was passed to constructor
+         */
+        QString path(const TorrentFilesTree& filesTree) const;
 
         int id{};
 
-        std::vector<QString> path{};
+        // Node of file in TorrentFilesTree, which stores its path
+        int node{-1};
         qint64 size{};
+    };
+
+    struct TorrentFileStats {
         qint64 completedSize{};
-        Priority priority{};
+        TorrentFile::Priority priority{};
         bool wanted{};
+
+        bool operator==(const TorrentFileStats& other) const = default;
+    };
+
+    /**
+     * Mutable properties of all files of torrent, stored column-wise and indexed by file id
+     */
+    class TorrentFilesStats {
+    public:
+        size_t size() const { return mCompletedSizes.size(); }
+        bool isEmpty() const { return mCompletedSizes.empty(); }
+        void clear();
+
+        TorrentFileStats at(size_t index) const {
+            return {
+                .completedSize = mCompletedSizes[index],
+                .priority = mPriorities[index],
+                .wanted = mWanted[index] != 0};
+        }
+        void set(size_t index, const TorrentFileStats& stats);
+
+        std::span<const qint64> completedSizes() const { return mCompletedSizes; }
+        std::span<const TorrentFile::Priority> priorities() const { return mPriorities; }
+        bool isWanted(size_t index) const { return mWanted[index] != 0; }
+
+        size_t memoryUsage() const {
+            return mCompletedSizes.capacity() * sizeof(qint64) +
+                   mPriorities.capacity() * sizeof(TorrentFile::Priority) + mWanted.capacity() * sizeof(uint8_t);
+        }
+
+        /**
+         * Replaces contents with stats from "fileStats" array of torrent-get response
+         */
+        void decode(const QJsonArray& fileStats);
+
+        /**
+         * Appends indexes of files which stats are different in other to changedIndexes
+         * Both must have the same size
+         */
+        void findChanged(const TorrentFilesStats& other, std::vector<int>& changedIndexes) const;
+
+    private:
+        std::vector<qint64> mCompletedSizes{};
+        std::vector<TorrentFile::Priority> mPriorities{};
+        // Not std::vector<bool> so that comparison loop can be vectorized
+        std::vector<uint8_t> mWanted{};
     };
 }
 
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "torrentfilestree.h"
+
+#include <algorithm>
+
+#include <QHash>
+
+namespace libtremotesf {
+    namespace {
+        constexpr auto separatorChar = u'/';
+
+        size_t priorityIndex(TorrentFile::Priority priority) { return static_cast<size_t>(priority); }
+    }
+
+    TorrentFilesTree::WantedState TorrentFilesTree::Node::wantedState() const {
+        if (wantedFilesCount == 0) return WantedState::Unwanted;
+        if (wantedFilesCount == filesCount) return WantedState::Wanted;
+        return WantedState::Mixed;
+    }
+
+    std::optional<TorrentFile::Priority> TorrentFilesTree::Node::priority() const {
+        for (size_t i = 0; i < filesCountByPriority.size(); ++i) {
+            if (filesCountByPriority[i] == filesCount) {
+                return static_cast<TorrentFile::Priority>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    size_t TorrentFilesTree::ChildKeyHash::operator()(const ChildKey& key) const {
+        return static_cast<size_t>(qHash(key.name)) ^ (static_cast<size_t>(key.parent) * 0x9e3779b9u);
+    }
+
+    int TorrentFilesTree::addFile(int fileId, QStringView path, qint64 size, const TorrentFileStats& stats) {
+        if (fileId < 0) {
+            return -1;
+        }
+
+        // Split path in place, without allocating strings for directories that already exist
+        int parent = rootNode;
+        QStringView leafName{};
+        qsizetype start = 0;
+        while (start < path.size()) {
+            auto end = path.indexOf(separatorChar, start);
+            if (end == -1) {
+                end = path.size();
+            }
+            if (end > start) {
+                const QStringView name = path.mid(start, end - start);
+                if (end == path.size()) {
+                    leafName = name;
+                } else {
+                    parent = findOrAddDirectory(parent, name);
+                }
+            }
+            start = end + 1;
+        }
+        if (leafName.isEmpty()) {
+            return -1;
+        }
+
+        const int index = static_cast<int>(mNodes.size());
+        Node leaf{.name = leafName.toString(), .parent = parent, .fileId = fileId};
+        leaf.size = size;
+        leaf.completedSize = stats.completedSize;
+        leaf.filesCount = 1;
+        leaf.wantedFilesCount = stats.wanted ? 1 : 0;
+        leaf.filesCountByPriority[priorityIndex(stats.priority)] = 1;
+        addToAncestors(parent, leaf);
+        mNodes.push_back(std::move(leaf));
+        mNodes[static_cast<size_t>(parent)].children.push_back(index);
+
+        if (static_cast<size_t>(fileId) >= mFileNodes.size()) {
+            mFileNodes.resize(static_cast<size_t>(fileId) + 1, -1);
+        }
+        mFileNodes[static_cast<size_t>(fileId)] = index;
+        return index;
+    }
+
+    void TorrentFilesTree::finishAdding() {
+        mDirectories = {};
+        mNodes.shrink_to_fit();
+    }
+
+    void TorrentFilesTree::clear() {
+        mNodes.clear();
+        mNodes.emplace_back();
+        mFileNodes.clear();
+        mDirectories = {};
+    }
+
+    int TorrentFilesTree::nodeForFile(int fileId) const {
+        if (fileId < 0 || static_cast<size_t>(fileId) >= mFileNodes.size()) {
+            return -1;
+        }
+        return mFileNodes[static_cast<size_t>(fileId)];
+    }
+
+    QString TorrentFilesTree::path(int index) const {
+        if (index <= rootNode || static_cast<size_t>(index) >= mNodes.size()) {
+            return {};
+        }
+        QString::size_type length = -1;
+        for (int i = index; i != rootNode; i = mNodes[static_cast<size_t>(i)].parent) {
+            length += mNodes[static_cast<size_t>(i)].name.size() + 1;
+        }
+        QString path(length, separatorChar);
+        auto end = length;
+        for (int i = index; i != rootNode; i = mNodes[static_cast<size_t>(i)].parent) {
+            const QString& name = mNodes[static_cast<size_t>(i)].name;
+            end -= name.size();
+            std::copy(name.cbegin(), name.cend(), path.begin() + end);
+            --end;
+        }
+        return path;
+    }
+
+    int TorrentFilesTree::findNode(QStringView path) const {
+        int index = rootNode;
+        qsizetype start = 0;
+        while (start < path.size()) {
+            auto end = path.indexOf(separatorChar, start);
+            if (end == -1) {
+                end = path.size();
+            }
+            if (end > start) {
+                const QStringView name = path.mid(start, end - start);
+                const auto& children = mNodes[static_cast<size_t>(index)].children;
+                const auto found = std::find_if(children.begin(), children.end(), [&](int child) {
+                    return QStringView(mNodes[static_cast<size_t>(child)].name) == name;
+                });
+                if (found == children.end()) {
+                    return -1;
+                }
+                index = *found;
+            }
+            start = end + 1;
+        }
+        return index == rootNode ? -1 : index;
+    }
+
+    void TorrentFilesTree::renameNode(int index, const QString& newName) {
+        if (index > rootNode && static_cast<size_t>(index) < mNodes.size()) {
+            mNodes[static_cast<size_t>(index)].name = newName;
+        }
+    }
+
+    std::vector<int> TorrentFilesTree::fileIds(int index) const {
+        std::vector<int> ids{};
+        if (index < rootNode || static_cast<size_t>(index) >= mNodes.size()) {
+            return ids;
+        }
+        ids.reserve(static_cast<size_t>(mNodes[static_cast<size_t>(index)].filesCount));
+        std::vector<int> stack{index};
+        while (!stack.empty()) {
+            const Node& node = mNodes[static_cast<size_t>(stack.back())];
+            stack.pop_back();
+            if (node.isDirectory()) {
+                stack.insert(stack.end(), node.children.begin(), node.children.end());
+            } else {
+                ids.push_back(node.fileId);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    size_t TorrentFilesTree::memoryUsage() const {
+        size_t bytes = mNodes.capacity() * sizeof(Node) + mFileNodes.capacity() * sizeof(int);
+        for (const Node& node : mNodes) {
+            bytes += node.children.capacity() * sizeof(int);
+            bytes += static_cast<size_t>(node.name.capacity()) * sizeof(QChar);
+        }
+        return bytes;
+    }
+
+    void TorrentFilesTree::updateFile(int fileId, const TorrentFileStats& oldStats, const TorrentFileStats& newStats) {
+        const qint64 completedSizeDelta = newStats.completedSize - oldStats.completedSize;
+        const int wantedDelta = static_cast<int>(newStats.wanted) - static_cast<int>(oldStats.wanted);
+        const bool priorityChanged = newStats.priority != oldStats.priority;
+        if (completedSizeDelta == 0 && wantedDelta == 0 && !priorityChanged) {
+            return;
+        }
+        for (int index = nodeForFile(fileId); index != -1;) {
+            Node& node = mNodes[static_cast<size_t>(index)];
+            node.completedSize += completedSizeDelta;
+            node.wantedFilesCount += wantedDelta;
+            if (priorityChanged) {
+                --node.filesCountByPriority[priorityIndex(oldStats.priority)];
+                ++node.filesCountByPriority[priorityIndex(newStats.priority)];
+            }
+            index = node.parent;
+        }
+    }
+
+    int TorrentFilesTree::findOrAddDirectory(int parent, QStringView name) {
+        if (const auto found = mDirectories.find(ChildKey{parent, name}); found != mDirectories.end()) {
+            return found->second;
+        }
+        const int index = static_cast<int>(mNodes.size());
+        mNodes.push_back(Node{.name = name.toString(), .parent = parent});
+        mNodes[static_cast<size_t>(parent)].children.push_back(index);
+        // QString's data is not moved when mNodes is reallocated, so view stays valid
+        mDirectories.emplace(ChildKey{parent, mNodes.back().name}, index);
+        return index;
+    }
+
+    void TorrentFilesTree::addToAncestors(int index, const Node& leaf) {
+        while (index != -1) {
+            Node& node = mNodes[static_cast<size_t>(index)];
+            node.size += leaf.size;
+            node.completedSize += leaf.completedSize;
+            node.filesCount += leaf.filesCount;
+            node.wantedFilesCount += leaf.wantedFilesCount;
+            for (size_t p = 0; p < node.filesCountByPriority.size(); ++p) {
+                node.filesCountByPriority[p] += leaf.filesCountByPriority[p];
+            }
+            index = node.parent;
+        }
+    }
+}
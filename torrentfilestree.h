@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_TORRENTFILESTREE_H
+#define LIBTREMOTESF_TORRENTFILESTREE_H
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <QString>
+#include <QStringView>
+
+#include "torrentfile.h"
+
+namespace libtremotesf {
+    /**
+     * Directory tree of torrent's files
+     * Directories aggregate size, completed size, wanted state and priority of all files below them.
+     * Aggregates are updated incrementally, only for ancestors of changed files
+     *
+     * Tree also serves as storage for paths of TorrentFile's: each directory name
+     * is stored once and files reference their leaf node
+     */
+    class TorrentFilesTree {
+    public:
+        static constexpr int rootNode = 0;
+
+        enum class WantedState { Unwanted, Mixed, Wanted };
+
+        struct Node {
+            QString name{};
+            // -1 for root
+            int parent{-1};
+            std::vector<int> children{};
+            // -1 for directories
+            int fileId{-1};
+
+            qint64 size{};
+            qint64 completedSize{};
+            int filesCount{};
+            int wantedFilesCount{};
+            std::array<int, 3> filesCountByPriority{};
+
+            bool isDirectory() const { return fileId == -1; }
+            WantedState wantedState() const;
+            // nullopt if files have different priorities
+            std::optional<TorrentFile::Priority> priority() const;
+        };
+
+        /**
+         * Adds file with '/'-separated path, creating its parent directories if needed
+         * Returns index of file's node, or -1 if path is empty
+         */
+        int addFile(int fileId, QStringView path, qint64 size, const TorrentFileStats& stats);
+        /**
+         * Releases lookup table used by addFile(). Must be called after all files are added
+         */
+        void finishAdding();
+        void clear();
+        bool isEmpty() const { return mNodes.size() <= 1; }
+
+        const Node& node(int index) const { return mNodes[static_cast<size_t>(index)]; }
+        size_t nodesCount() const { return mNodes.size(); }
+        // -1 if there is no such file
+        int nodeForFile(int fileId) const;
+
+        /**
+         * Returns '/'-separated path of node relative to root node
+         */
+        QString path(int index) const;
+
+        /**
+         * Returns node with '/'-separated path relative to root node, or -1 if there is no such node
+         */
+        int findNode(QStringView path) const;
+
+        /**
+         * Changes name of node, which changes paths of all files in its subtree
+         */
+        void renameNode(int index, const QString& newName);
+
+        /**
+         * Returns ids of all files in subtree of node, in ascending order
+         */
+        std::vector<int> fileIds(int index) const;
+
+        /**
+         * Approximate memory used by tree
+         */
+        size_t memoryUsage() const;
+
+        /**
+         * Updates aggregates of ancestors of file's node
+         */
+        void updateFile(int fileId, const TorrentFileStats& oldStats, const TorrentFileStats& newStats);
+
+    private:
+        struct ChildKey {
+            int parent{};
+            // Points to name of child node
+            QStringView name{};
+
+            bool operator==(const ChildKey& other) const = default;
+        };
+
+        struct ChildKeyHash {
+            size_t operator()(const ChildKey& key) const;
+        };
+
+        int findOrAddDirectory(int parent, QStringView name);
+        void addToAncestors(int index, const Node& leaf);
+
+        std::vector<Node> mNodes{Node{}};
+        // Indexed by file id
+        std::vector<int> mFileNodes{};
+        // Only while adding files
+        std::unordered_map<ChildKey, int, ChildKeyHash> mDirectories{};
+    };
+}
+
+#endif // LIBTREMOTESF_TORRENTFILESTREE_H
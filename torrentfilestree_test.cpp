@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTest>
+
+#include "literals.h"
+#include "torrentfilestree.h"
+
+using namespace libtremotesf;
+
+namespace {
+    constexpr auto normal = TorrentFile::Priority::Normal;
+    constexpr auto high = TorrentFile::Priority::High;
+
+    TorrentFile makeFile(
+        TorrentFilesTree& tree,
+        int id,
+        const QString& name,
+        qint64 size,
+        qint64 completedSize,
+        TorrentFile::Priority priority,
+        bool wanted
+    ) {
+        return TorrentFile(
+            id,
+            QJsonObject{{"name"_l1, name}, {"length"_l1, size}},
+            TorrentFileStats{.completedSize = completedSize, .priority = priority, .wanted = wanted},
+            tree
+        );
+    }
+
+    int childByName(const TorrentFilesTree& tree, int parent, const QString& name) {
+        for (int child : tree.node(parent).children) {
+            if (tree.node(child).name == name) {
+                return child;
+            }
+        }
+        return -1;
+    }
+}
+
+class TorrentFilesTreeTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void buildAggregates() {
+        TorrentFilesTree tree{};
+        makeFile(tree, 0, "root/a/1"_l1, 100, 50, normal, true);
+        makeFile(tree, 1, "root/a/2"_l1, 200, 200, normal, true);
+        makeFile(tree, 2, "root/b"_l1, 300, 0, high, false);
+        tree.finishAdding();
+        QVERIFY(!tree.isEmpty());
+        QVERIFY(tree.nodesCount() == 6);
+
+        const int root = childByName(tree, TorrentFilesTree::rootNode, "root"_l1);
+        QVERIFY(root != -1);
+        const auto& rootNode = tree.node(root);
+        QVERIFY(rootNode.isDirectory());
+        QCOMPARE(rootNode.size, qint64{600});
+        QCOMPARE(rootNode.completedSize, qint64{250});
+        QCOMPARE(rootNode.filesCount, 3);
+        QVERIFY(rootNode.wantedState() == TorrentFilesTree::WantedState::Mixed);
+        QVERIFY(!rootNode.priority().has_value());
+
+        const int a = childByName(tree, root, "a"_l1);
+        const auto& aNode = tree.node(a);
+        QCOMPARE(aNode.size, qint64{300});
+        QVERIFY(aNode.wantedState() == TorrentFilesTree::WantedState::Wanted);
+        QVERIFY(aNode.priority() == TorrentFile::Priority::Normal);
+
+        const int b = tree.nodeForFile(2);
+        QCOMPARE(b, childByName(tree, root, "b"_l1));
+        QVERIFY(!tree.node(b).isDirectory());
+        QVERIFY(tree.node(b).wantedState() == TorrentFilesTree::WantedState::Unwanted);
+        QVERIFY(tree.node(b).priority() == TorrentFile::Priority::High);
+
+        QCOMPARE(tree.nodeForFile(3), -1);
+    }
+
+    void updateFilePropagatesToAncestors() {
+        TorrentFilesTree tree{};
+        makeFile(tree, 0, "root/a/1"_l1, 100, 0, normal, true);
+        makeFile(tree, 1, "root/b"_l1, 100, 0, normal, true);
+        tree.finishAdding();
+
+        tree.updateFile(
+            0,
+            TorrentFileStats{.completedSize = 0, .priority = normal, .wanted = true},
+            TorrentFileStats{.completedSize = 100, .priority = TorrentFile::Priority::Low, .wanted = false}
+        );
+
+        const int root = childByName(tree, TorrentFilesTree::rootNode, "root"_l1);
+        QCOMPARE(tree.node(root).completedSize, qint64{100});
+        QVERIFY(tree.node(root).wantedState() == TorrentFilesTree::WantedState::Mixed);
+        QVERIFY(!tree.node(root).priority().has_value());
+
+        const int a = childByName(tree, root, "a"_l1);
+        QCOMPARE(tree.node(a).completedSize, qint64{100});
+        QVERIFY(tree.node(a).wantedState() == TorrentFilesTree::WantedState::Unwanted);
+        QVERIFY(tree.node(a).priority() == TorrentFile::Priority::Low);
+
+        QCOMPARE(tree.node(TorrentFilesTree::rootNode).completedSize, qint64{100});
+    }
+
+    void paths() {
+        TorrentFilesTree tree{};
+        const auto first = makeFile(tree, 0, "root/dir/file"_l1, 1, 0, normal, true);
+        const auto second = makeFile(tree, 1, "/root//dir/other/"_l1, 1, 0, normal, true);
+        const auto single = makeFile(tree, 2, "single"_l1, 1, 0, normal, true);
+        tree.finishAdding();
+
+        QCOMPARE(first.path(tree), "root/dir/file"_l1);
+        QCOMPARE(second.path(tree), "root/dir/other"_l1);
+        QCOMPARE(single.path(tree), "single"_l1);
+        QCOMPARE(tree.node(first.node).parent, tree.node(second.node).parent);
+        // Root node, 'root', 'dir' and 3 files
+        QVERIFY(tree.nodesCount() == 6);
+    }
+
+    void subtreeFileIds() {
+        TorrentFilesTree tree{};
+        makeFile(tree, 0, "root/a/1"_l1, 1, 0, normal, true);
+        makeFile(tree, 1, "root/b"_l1, 1, 0, normal, true);
+        makeFile(tree, 2, "root/a/2"_l1, 1, 0, normal, true);
+        tree.finishAdding();
+
+        const int root = childByName(tree, TorrentFilesTree::rootNode, "root"_l1);
+        QVERIFY(tree.fileIds(root) == (std::vector{0, 1, 2}));
+        QVERIFY(tree.fileIds(childByName(tree, root, "a"_l1)) == (std::vector{0, 2}));
+        QVERIFY(tree.fileIds(tree.nodeForFile(1)) == std::vector{1});
+        QVERIFY(tree.fileIds(-1).empty());
+    }
+
+    void renameDirectory() {
+        TorrentFilesTree tree{};
+        const auto first = makeFile(tree, 0, "root/a/1"_l1, 1, 0, normal, true);
+        const auto second = makeFile(tree, 1, "root/b"_l1, 1, 0, normal, true);
+        tree.finishAdding();
+
+        const int a = tree.findNode(u"root/a");
+        QVERIFY(a != -1);
+        QCOMPARE(tree.findNode(u"root/a/1"), first.node);
+        QCOMPARE(tree.findNode(u"root/c"), -1);
+        QCOMPARE(tree.findNode(QString()), -1);
+
+        tree.renameNode(a, "renamed"_l1);
+        QCOMPARE(first.path(tree), "root/renamed/1"_l1);
+        QCOMPARE(second.path(tree), "root/b"_l1);
+        QCOMPARE(tree.findNode(u"root/renamed/1"), first.node);
+    }
+
+    void emptyPath() {
+        TorrentFilesTree tree{};
+        const auto file = makeFile(tree, 0, "//"_l1, 1, 0, normal, true);
+        QCOMPARE(file.node, -1);
+        QVERIFY(file.path(tree).isEmpty());
+        QVERIFY(tree.isEmpty());
+    }
+
+    void filesStatsFindChanged() {
+        const auto fileStats = [](qint64 completedSize, int priority, bool wanted) {
+            return QJsonObject{
+                {"bytesCompleted"_l1, completedSize},
+                {"priority"_l1, priority},
+                {"wanted"_l1, wanted}};
+        };
+        TorrentFilesStats oldStats{};
+        oldStats.decode(QJsonArray{fileStats(0, 0, true), fileStats(10, 1, true), fileStats(20, -1, false)});
+        QVERIFY(oldStats.size() == 3);
+        QVERIFY(oldStats.at(1) == (TorrentFileStats{.completedSize = 10, .priority = high, .wanted = true}));
+        QVERIFY(!oldStats.isWanted(2));
+
+        TorrentFilesStats newStats{};
+        newStats.decode(QJsonArray{fileStats(5, 0, true), fileStats(10, 1, true), fileStats(20, -1, true)});
+        std::vector<int> changed{};
+        oldStats.findChanged(newStats, changed);
+        QVERIFY(changed == (std::vector{0, 2}));
+    }
+
+    void clear() {
+        TorrentFilesTree tree{};
+        makeFile(tree, 0, "file"_l1, 1, 0, normal, true);
+        QVERIFY(!tree.isEmpty());
+        tree.clear();
+        QVERIFY(tree.isEmpty());
+        QCOMPARE(tree.nodeForFile(0), -1);
+    }
+};
+
+QTEST_MAIN(TorrentFilesTreeTest)
+
+#include "torrentfilestree_test.moc"
@@ -17,6 +17,7 @@
 #include "jsonutils.h"
 #include "literals.h"
 #include "stdutils.h"
+#include "stringpool.h"
 
 namespace libtremotesf {
     using namespace impl;
@@ -33,11 +34,13 @@ namespace libtremotesf {
     bool Tracker::update(const QJsonObject& trackerMap) {
         bool changed = false;
 
-        QString announce(trackerMap.value("announce"_l1).toString());
-        if (announce != mAnnounce) {
-            changed = true;
+        QString announce = internString(trackerMap.value("announce"_l1).toString());
+        if (announce.constData() != mAnnounce.constData()) {
+            if (announce != mAnnounce) {
+                changed = true;
+                mSite = TrackerSitesCache::instance().siteForAnnounceUrl(announce);
+            }
             mAnnounce = std::move(announce);
-            mSite = registrableDomainFromUrl(QUrl(mAnnounce));
         }
 
         const bool announceError =
@@ -73,10 +76,91 @@ namespace libtremotesf {
             }(),
             changed
         );
-        updateDateTime(mNextUpdateTime, trackerMap.value("nextAnnounceTime"_l1), changed);
+        updateDateTime(mNextUpdateTimeSecs, trackerMap.value("nextAnnounceTime"_l1), changed);
+
+        constexpr auto scrapeStateKey = "scrapeState"_l1;
+        setChanged(
+            mScrapeStatus,
+            statusMapper.fromJsonValue(trackerMap.value(scrapeStateKey), scrapeStateKey),
+            changed
+        );
+        updateDateTime(mNextScrapeTimeSecs, trackerMap.value("nextScrapeTime"_l1), changed);
 
         return changed;
     }
+
+    QDateTime Tracker::nextUpdateTime() const { return dateTimeFromSecsSinceEpoch(mNextUpdateTimeSecs); }
+
+    namespace impl {
+        std::optional<QStringView> hostFromUrl(QStringView url) {
+            const auto schemeEnd = url.indexOf(u"://");
+            if (schemeEnd <= 0) {
+                return std::nullopt;
+            }
+            QStringView authority = url.mid(schemeEnd + 3);
+            for (qsizetype i = 0; i < authority.size(); ++i) {
+                const QChar ch = authority[i];
+                if (ch == '/' || ch == '?' || ch == '#') {
+                    authority = authority.left(i);
+                    break;
+                }
+            }
+            if (const auto userInfoEnd = authority.lastIndexOf(u'@'); userInfoEnd != -1) {
+                authority = authority.mid(userInfoEnd + 1);
+            }
+
+            QStringView host{};
+            if (authority.startsWith(u'[')) {
+                const auto ipv6End = authority.indexOf(u']');
+                if (ipv6End == -1) {
+                    return std::nullopt;
+                }
+                host = authority.left(ipv6End + 1);
+            } else {
+                const auto portStart = authority.indexOf(u':');
+                host = (portStart == -1) ? authority : authority.left(portStart);
+            }
+            if (host.isEmpty()) {
+                return std::nullopt;
+            }
+            // Leave percent-encoded and internationalized hosts to QUrl
+            for (const QChar ch : host) {
+                if (ch.unicode() >= 0x80 || ch == '%') {
+                    return std::nullopt;
+                }
+            }
+            return host;
+        }
+
+        TrackerSitesCache& TrackerSitesCache::instance() {
+            static TrackerSitesCache cache{};
+            return cache;
+        }
+
+        QString TrackerSitesCache::siteForAnnounceUrl(const QString& announce) {
+            const auto host = hostFromUrl(announce);
+            if (!host.has_value()) {
+                return internString(registrableDomainFromUrl(QUrl(announce)));
+            }
+            const QString key = host->toString();
+            const std::lock_guard lock(mMutex);
+            if (const auto found = mSites.constFind(key); found != mSites.constEnd()) {
+                return found.value();
+            }
+            if (mSites.size() >= maximumSize) {
+                // Distinct hosts are expected to be few, so there is no point in tracking usage
+                mSites.clear();
+            }
+            QString site = internString(registrableDomainFromUrl(QUrl(announce)));
+            mSites.insert(key, site);
+            return site;
+        }
+
+        qsizetype TrackerSitesCache::size() const {
+            const std::lock_guard lock(mMutex);
+            return mSites.size();
+        }
+    }
 }
 
 #ifdef LIBTREMOTESF_REGISTRABLE_DOMAIN_QT
@@ -5,9 +5,14 @@
 #ifndef LIBTREMOTESF_TRACKER_H
 #define LIBTREMOTESF_TRACKER_H
 
+#include <mutex>
+#include <optional>
+
 #include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QString>
+#include <QStringView>
 
 #include "formatters.h"
 
@@ -42,7 +47,11 @@ namespace libtremotesf {
         int peers() const { return mPeers; };
         int seeders() const { return mSeeders; }
         int leechers() const { return mLeechers; }
-        const QDateTime& nextUpdateTime() const { return mNextUpdateTime; };
+        QDateTime nextUpdateTime() const;
+        qint64 nextUpdateTimeSecs() const { return mNextUpdateTimeSecs; }
+
+        Status scrapeStatus() const { return mScrapeStatus; }
+        qint64 nextScrapeTimeSecs() const { return mNextScrapeTimeSecs; }
 
         bool update(const QJsonObject& trackerMap);
 
@@ -55,7 +64,10 @@ namespace libtremotesf {
         Status mStatus{};
         QString mErrorMessage{};
 
-        QDateTime mNextUpdateTime{{}, {}, Qt::UTC};
+        qint64 mNextUpdateTimeSecs{};
+
+        Status mScrapeStatus{};
+        qint64 mNextScrapeTimeSecs{};
 
         int mPeers{};
         int mSeeders{};
@@ -66,6 +78,30 @@ namespace libtremotesf {
 
     namespace impl {
         QString registrableDomainFromUrl(const QUrl& url);
+
+        /**
+         * Extracts host from URL without parsing it with QUrl
+         * Returns nullopt if URL is not in 'scheme://[userinfo@]host[:port][/...]' form
+         * or if host needs decoding or normalization
+         */
+        std::optional<QStringView> hostFromUrl(QStringView url);
+
+        /**
+         * Thread-safe cache of registrable domains of announce URLs, keyed by host
+         */
+        class TrackerSitesCache {
+        public:
+            static TrackerSitesCache& instance();
+
+            QString siteForAnnounceUrl(const QString& announce);
+            qsizetype size() const;
+
+            static constexpr qsizetype maximumSize = 4096;
+
+        private:
+            mutable std::mutex mMutex{};
+            QHash<QString, QString> mSites{};
+        };
     }
 }
 
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "trackersdirectory.h"
+
+#include <algorithm>
+
+namespace libtremotesf {
+    const TrackerSiteStats* TrackersDirectory::site(const QString& site) const {
+        const auto found = mSites.constFind(site);
+        return found == mSites.constEnd() ? nullptr : &found.value();
+    }
+
+    void TrackersDirectory::updateTorrent(int torrentId, std::span<const Tracker> trackers) {
+        std::vector<Contribution> contributions{};
+        for (const Tracker& tracker : trackers) {
+            // Torrents usually have few trackers, so linear search is fine
+            auto found = std::find_if(contributions.begin(), contributions.end(), [&](const Contribution& other) {
+                return other.site == tracker.site();
+            });
+            if (found == contributions.end()) {
+                contributions.push_back(Contribution{.site = tracker.site()});
+                found = contributions.end() - 1;
+            }
+            ++found->trackersCount;
+            if (!tracker.errorMessage().isEmpty()) {
+                ++found->errorsCount;
+            }
+            found->seeders += tracker.seeders();
+            found->leechers += tracker.leechers();
+            if (tracker.nextUpdateTimeSecs() > 0) {
+                found->nextUpdateTimes.push_back(tracker.nextUpdateTimeSecs());
+            }
+        }
+
+        auto& previous = mTorrents[torrentId];
+        for (const auto& contribution : previous) {
+            apply(contribution, false);
+        }
+        for (const auto& contribution : contributions) {
+            apply(contribution, true);
+        }
+        if (contributions.empty()) {
+            mTorrents.erase(torrentId);
+        } else {
+            previous = std::move(contributions);
+        }
+    }
+
+    void TrackersDirectory::removeTorrent(int torrentId) {
+        const auto found = mTorrents.find(torrentId);
+        if (found != mTorrents.end()) {
+            for (const auto& contribution : found->second) {
+                apply(contribution, false);
+            }
+            mTorrents.erase(found);
+        }
+    }
+
+    void TrackersDirectory::clear() {
+        mSites.clear();
+        mNextUpdateTimes.clear();
+        mTorrents.clear();
+    }
+
+    void TrackersDirectory::apply(const Contribution& contribution, bool add) {
+        const int sign = add ? 1 : -1;
+        TrackerSiteStats& stats = mSites[contribution.site];
+        stats.torrentsCount += sign;
+        stats.trackersCount += sign * contribution.trackersCount;
+        stats.errorsCount += sign * contribution.errorsCount;
+        stats.seeders += sign * contribution.seeders;
+        stats.leechers += sign * contribution.leechers;
+        if (stats.torrentsCount <= 0) {
+            mSites.remove(contribution.site);
+            mNextUpdateTimes.remove(contribution.site);
+            return;
+        }
+
+        if (!contribution.nextUpdateTimes.empty()) {
+            auto& times = mNextUpdateTimes[contribution.site];
+            for (const qint64 time : contribution.nextUpdateTimes) {
+                if (add) {
+                    times.insert(time);
+                } else if (const auto found = times.find(time); found != times.end()) {
+                    times.erase(found);
+                }
+            }
+            stats.nextUpdateTimeSecs = times.empty() ? 0 : *times.begin();
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_TRACKERSDIRECTORY_H
+#define LIBTREMOTESF_TRACKERSDIRECTORY_H
+
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+#include "tracker.h"
+
+namespace libtremotesf {
+    struct TrackerSiteStats {
+        // Number of torrents that have at least one tracker with this site
+        int torrentsCount{};
+        int trackersCount{};
+        // Number of trackers with announce error
+        int errorsCount{};
+        int seeders{};
+        int leechers{};
+        // Earliest next announce of trackers with this site, 0 if none is scheduled
+        qint64 nextUpdateTimeSecs{};
+    };
+
+    /**
+     * Statistics of trackers of all torrents, grouped by tracker site
+     * Updated incrementally when trackers of a torrent change, see Rpc::trackersDirectory()
+     */
+    class TrackersDirectory {
+    public:
+        /**
+         * Returns nullptr if no torrent has tracker with this site
+         */
+        const TrackerSiteStats* site(const QString& site) const;
+        const QHash<QString, TrackerSiteStats>& sites() const { return mSites; }
+
+        void updateTorrent(int torrentId, std::span<const Tracker> trackers);
+        void removeTorrent(int torrentId);
+        void clear();
+
+    private:
+        struct Contribution {
+            QString site{};
+            int trackersCount{};
+            int errorsCount{};
+            int seeders{};
+            int leechers{};
+            std::vector<qint64> nextUpdateTimes{};
+        };
+
+        void apply(const Contribution& contribution, bool add);
+
+        QHash<QString, TrackerSiteStats> mSites{};
+        QHash<QString, std::multiset<qint64>> mNextUpdateTimes{};
+        std::unordered_map<int, std::vector<Contribution>> mTorrents{};
+    };
+}
+
+#endif // LIBTREMOTESF_TRACKERSDIRECTORY_H
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QJsonObject>
+#include <QTest>
+
+#include "literals.h"
+#include "trackersdirectory.h"
+
+using namespace libtremotesf;
+
+namespace {
+    Tracker makeTracker(int id, const QString& announce, int seeders, qint64 nextAnnounceTime, bool error = false) {
+        return Tracker(
+            id,
+            QJsonObject{
+                {"announce"_l1, announce},
+                {"seederCount"_l1, seeders},
+                {"leecherCount"_l1, 1},
+                {"nextAnnounceTime"_l1, nextAnnounceTime},
+                {"lastAnnounceTime"_l1, error ? 1 : 0},
+                {"lastAnnounceSucceeded"_l1, !error},
+                {"lastAnnounceResult"_l1, "Error"_l1}}
+        );
+    }
+}
+
+class TrackersDirectoryTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void aggregatesBySite() {
+        TrackersDirectory directory{};
+        const std::vector first{
+            makeTracker(0, "https://tracker.example.com/announce"_l1, 10, 100),
+            makeTracker(1, "udp://udp.example.com:6969"_l1, 5, 50, true)};
+        const std::vector second{makeTracker(0, "https://other.org/announce"_l1, 3, 0)};
+        directory.updateTorrent(1, first);
+        directory.updateTorrent(2, second);
+
+        QVERIFY(directory.sites().size() == 2);
+        const auto* example = directory.site("example.com"_l1);
+        QVERIFY(example);
+        QCOMPARE(example->torrentsCount, 1);
+        QCOMPARE(example->trackersCount, 2);
+        QCOMPARE(example->errorsCount, 1);
+        QCOMPARE(example->seeders, 15);
+        QCOMPARE(example->leechers, 2);
+        QCOMPARE(example->nextUpdateTimeSecs, qint64{50});
+
+        const auto* other = directory.site("other.org"_l1);
+        QVERIFY(other);
+        QCOMPARE(other->nextUpdateTimeSecs, qint64{0});
+    }
+
+    void updateAndRemoveTorrent() {
+        TrackersDirectory directory{};
+        directory.updateTorrent(1, std::vector{makeTracker(0, "https://example.com/announce"_l1, 10, 100)});
+        directory.updateTorrent(2, std::vector{makeTracker(0, "https://example.com/announce"_l1, 1, 200)});
+        QCOMPARE(directory.site("example.com"_l1)->torrentsCount, 2);
+        QCOMPARE(directory.site("example.com"_l1)->seeders, 11);
+
+        directory.updateTorrent(1, std::vector{makeTracker(0, "https://example.com/announce"_l1, 20, 300)});
+        QCOMPARE(directory.site("example.com"_l1)->torrentsCount, 2);
+        QCOMPARE(directory.site("example.com"_l1)->seeders, 21);
+        QCOMPARE(directory.site("example.com"_l1)->nextUpdateTimeSecs, qint64{200});
+
+        directory.removeTorrent(2);
+        QCOMPARE(directory.site("example.com"_l1)->torrentsCount, 1);
+        QCOMPARE(directory.site("example.com"_l1)->nextUpdateTimeSecs, qint64{300});
+
+        directory.updateTorrent(1, {});
+        QVERIFY(!directory.site("example.com"_l1));
+        QVERIFY(directory.sites().isEmpty());
+    }
+};
+
+QTEST_MAIN(TrackersDirectoryTest)
+
+#include "trackersdirectory_test.moc"
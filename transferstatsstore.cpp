@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "transferstatsstore.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <QFile>
+#include <QtEndian>
+
+#include "fileutils.h"
+#include "log.h"
+
+namespace libtremotesf {
+    namespace impl {
+        using namespace transferstats;
+
+        namespace {
+            qint64 fileSizeForCapacity(uint32_t capacity) {
+                return static_cast<qint64>(sizeof(FileHeader) + static_cast<size_t>(capacity) * recordSize);
+            }
+        }
+
+        TimeSeriesFile::TimeSeriesFile(const QString& path, uint32_t capacity)
+            : mFile(std::make_unique<QFile>(path)), mCapacity(capacity) {
+            if (capacity == 0) {
+                throw std::invalid_argument("Time series file capacity must not be 0");
+            }
+            const auto fileSize = fileSizeForCapacity(capacity);
+            libtremotesf::openFile(*mFile, QIODevice::ReadWrite);
+            const auto existingSize = mFile->size();
+            if (existingSize != fileSize && !mFile->resize(fileSize)) {
+                throw QFileError(fmt::format("Failed to resize transfer stats file {}", path));
+            }
+            mMapping = mFile->map(0, fileSize);
+            if (!mMapping) {
+                throw QFileError(fmt::format("Failed to map transfer stats file {}", path));
+            }
+
+            if (existingSize == fileSize) {
+                const auto existing = header();
+                if (std::memcmp(existing.magic, magic.data(), magic.size()) == 0 && existing.version == version &&
+                    existing.recordSize == recordSize && existing.capacity == capacity &&
+                    existing.start < capacity && existing.count <= capacity) {
+                    mStart = existing.start;
+                    mCount = existing.count;
+                    repairTornRing(path);
+                    return;
+                }
+            }
+            if (existingSize != 0) {
+                logWarning("Transfer stats file {} has unexpected format, recreating it", path);
+            }
+            FileHeader created{};
+            std::memcpy(created.magic, magic.data(), magic.size());
+            created.version = version;
+            created.recordSize = static_cast<uint32_t>(recordSize);
+            created.capacity = capacity;
+            writeHeader(created);
+        }
+
+        void TimeSeriesFile::repairTornRing(const QString& path) {
+            const auto oldStart = mStart;
+            const auto oldCount = mCount;
+            // Record is written before header, so if we crashed in between when ring was full
+            // then the oldest record was already overwritten with the newest one
+            if (mCount == mCapacity && mCount > 1 && at(0).timeSecs > at(mCount - 1).timeSecs) {
+                mStart = (mStart + 1) % mCapacity;
+            }
+            // Drop everything after first record that is not newer than previous one
+            for (uint32_t i = 1; i < mCount; ++i) {
+                if (at(i).timeSecs <= at(i - 1).timeSecs) {
+                    mCount = i;
+                    break;
+                }
+            }
+            if (mStart != oldStart || mCount != oldCount) {
+                logWarning(
+                    "Transfer stats file {} was not written completely, keeping {} of {} records",
+                    path,
+                    mCount,
+                    oldCount
+                );
+                auto updated = header();
+                updated.start = mStart;
+                updated.count = mCount;
+                writeHeader(updated);
+            }
+        }
+
+        TimeSeriesFile::~TimeSeriesFile() {
+            if (mMapping) {
+                mFile->unmap(mMapping);
+            }
+        }
+
+        size_t TimeSeriesFile::size() const { return mCount; }
+
+        size_t TimeSeriesFile::capacity() const { return mCapacity; }
+
+        TransferStatsRecord TimeSeriesFile::at(size_t index) const {
+            const uchar* const record = recordAt((mStart + index) % mCapacity);
+            return {
+                .timeSecs = qFromLittleEndian<qint64>(record),
+                .downloaded = qFromLittleEndian<qint64>(record + sizeof(qint64)),
+                .uploaded = qFromLittleEndian<qint64>(record + 2 * sizeof(qint64))
+            };
+        }
+
+        void TimeSeriesFile::append(const TransferStatsRecord& record) {
+            size_t index{};
+            if (mCount < mCapacity) {
+                index = (mStart + mCount) % mCapacity;
+                ++mCount;
+            } else {
+                index = mStart;
+                mStart = (mStart + 1) % mCapacity;
+            }
+            uchar* const destination = recordAt(index);
+            qToLittleEndian(record.timeSecs, destination);
+            qToLittleEndian(record.downloaded, destination + sizeof(qint64));
+            qToLittleEndian(record.uploaded, destination + 2 * sizeof(qint64));
+
+            // Header is updated after record, see repairTornRing()
+            auto updated = header();
+            updated.start = mStart;
+            updated.count = mCount;
+            writeHeader(updated);
+        }
+
+        void TimeSeriesFile::replaceLast(const TransferStatsRecord& record) {
+            if (mCount == 0) {
+                throw std::logic_error("Time series file is empty");
+            }
+            uchar* const destination = recordAt((mStart + mCount - 1) % mCapacity);
+            qToLittleEndian(record.timeSecs, destination);
+            qToLittleEndian(record.downloaded, destination + sizeof(qint64));
+            qToLittleEndian(record.uploaded, destination + 2 * sizeof(qint64));
+        }
+
+        std::vector<TransferStatsRecord> TimeSeriesFile::range(qint64 fromSecs, qint64 toSecs) const {
+            // Lower bound of fromSecs
+            size_t first = 0;
+            size_t last = mCount;
+            while (first < last) {
+                const auto middle = first + (last - first) / 2;
+                if (at(middle).timeSecs < fromSecs) {
+                    first = middle + 1;
+                } else {
+                    last = middle;
+                }
+            }
+            std::vector<TransferStatsRecord> records{};
+            for (size_t i = first; i < mCount; ++i) {
+                const auto record = at(i);
+                if (record.timeSecs > toSecs) {
+                    break;
+                }
+                records.push_back(record);
+            }
+            return records;
+        }
+
+        FileHeader TimeSeriesFile::header() const {
+            FileHeader header{};
+            std::memcpy(header.magic, mMapping, sizeof(header.magic));
+            const uchar* fields = mMapping + sizeof(header.magic);
+            for (uint32_t* field : {
+                     &header.version,
+                     &header.recordSize,
+                     &header.capacity,
+                     &header.start,
+                     &header.count,
+                     &header.reserved
+                 }) {
+                *field = qFromLittleEndian<uint32_t>(fields);
+                fields += sizeof(uint32_t);
+            }
+            return header;
+        }
+
+        void TimeSeriesFile::writeHeader(const FileHeader& header) {
+            std::memcpy(mMapping, header.magic, sizeof(header.magic));
+            uchar* fields = mMapping + sizeof(header.magic);
+            for (uint32_t field :
+                 {header.version, header.recordSize, header.capacity, header.start, header.count, header.reserved}) {
+                qToLittleEndian(field, fields);
+                fields += sizeof(uint32_t);
+            }
+        }
+
+        uchar* TimeSeriesFile::recordAt(size_t index) const {
+            return mMapping + sizeof(FileHeader) + index * recordSize;
+        }
+    }
+
+    namespace {
+        constexpr std::array resolutions{TransferStatsStore::Resolution::Minute, TransferStatsStore::Resolution::Hour};
+
+        QString suffix(TransferStatsStore::Resolution resolution) {
+            switch (resolution) {
+            case TransferStatsStore::Resolution::Minute:
+                return QStringLiteral(".minutes");
+            case TransferStatsStore::Resolution::Hour:
+                return QStringLiteral(".hours");
+            }
+            throw std::logic_error("Unknown TransferStatsStore::Resolution value");
+        }
+    }
+
+    TransferStatsStore::TransferStatsStore(const QString& basePath) {
+        for (const auto resolution : resolutions) {
+            mFiles[static_cast<size_t>(resolution)] =
+                std::make_unique<impl::TimeSeriesFile>(basePath + suffix(resolution), capacity(resolution));
+        }
+    }
+
+    TransferStatsStore::~TransferStatsStore() = default;
+
+    void TransferStatsStore::append(qint64 timeSecs, qint64 downloaded, qint64 uploaded) {
+        // Hourly records are rollups of minute ones: both keep totals from last sample of their interval
+        for (const auto resolution : resolutions) {
+            auto& file = *mFiles[static_cast<size_t>(resolution)];
+            const TransferStatsRecord record{
+                .timeSecs = timeSecs - timeSecs % intervalSecs(resolution),
+                .downloaded = downloaded,
+                .uploaded = uploaded
+            };
+            if (file.size() == 0) {
+                file.append(record);
+                continue;
+            }
+            const auto lastTimeSecs = file.at(file.size() - 1).timeSecs;
+            if (record.timeSecs == lastTimeSecs) {
+                file.replaceLast(record);
+            } else if (record.timeSecs > lastTimeSecs) {
+                file.append(record);
+            }
+        }
+    }
+
+    std::vector<TransferStatsRecord>
+    TransferStatsStore::range(Resolution resolution, qint64 fromSecs, qint64 toSecs) const {
+        return mFiles[static_cast<size_t>(resolution)]->range(fromSecs, toSecs);
+    }
+
+    size_t TransferStatsStore::size(Resolution resolution) const {
+        return mFiles[static_cast<size_t>(resolution)]->size();
+    }
+}
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LIBTREMOTESF_TRANSFERSTATSSTORE_H
+#define LIBTREMOTESF_TRANSFERSTATSSTORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <QString>
+
+class QFile;
+
+namespace libtremotesf {
+    struct TransferStatsRecord {
+        // Start of interval
+        qint64 timeSecs{};
+        // Total downloaded and uploaded bytes at the end of interval
+        qint64 downloaded{};
+        qint64 uploaded{};
+
+        bool operator==(const TransferStatsRecord& other) const = default;
+    };
+
+    namespace impl {
+        /**
+         * Time series file layout (all integers are little-endian):
+         * - File header: magic (8 bytes), version, record size, capacity, index of oldest record,
+         *   records count and reserved field (uint32 each)
+         * - Ring of `capacity` fixed-size records: time, downloaded, uploaded (int64 each)
+         *
+         * File has constant size, so it is mapped once and records are read and written in place
+         * It is a ring that overwrites its oldest records, not an append-only log
+         */
+        namespace transferstats {
+            inline constexpr std::string_view magic = "TRSTATS1";
+            inline constexpr uint32_t version = 1;
+
+            struct FileHeader {
+                char magic[8];
+                uint32_t version;
+                uint32_t recordSize;
+                uint32_t capacity;
+                uint32_t start;
+                uint32_t count;
+                uint32_t reserved;
+            };
+            static_assert(sizeof(FileHeader) == 32);
+
+            inline constexpr size_t recordSize = 3 * sizeof(int64_t);
+        }
+
+        /**
+         * Memory mapped ring of records in chronological order
+         * On opening, records that are out of order because of interrupted write are dropped
+         * Throws QFileError if file can't be created or mapped
+         */
+        class TimeSeriesFile {
+        public:
+            TimeSeriesFile(const QString& path, uint32_t capacity);
+            ~TimeSeriesFile();
+            Q_DISABLE_COPY_MOVE(TimeSeriesFile)
+
+            [[nodiscard]] size_t size() const;
+            [[nodiscard]] size_t capacity() const;
+            // 0 is the oldest record
+            [[nodiscard]] TransferStatsRecord at(size_t index) const;
+
+            /**
+             * Overwrites the oldest record if file is full
+             */
+            void append(const TransferStatsRecord& record);
+            void replaceLast(const TransferStatsRecord& record);
+
+            /**
+             * Returns records with fromSecs <= timeSecs <= toSecs
+             * Records are found with binary search and are read directly from mapping
+             */
+            [[nodiscard]] std::vector<TransferStatsRecord> range(qint64 fromSecs, qint64 toSecs) const;
+
+        private:
+            void repairTornRing(const QString& path);
+            [[nodiscard]] transferstats::FileHeader header() const;
+            void writeHeader(const transferstats::FileHeader& header);
+            [[nodiscard]] uchar* recordAt(size_t index) const;
+
+            std::unique_ptr<QFile> mFile;
+            uchar* mMapping{};
+            uint32_t mCapacity{};
+            uint32_t mStart{};
+            uint32_t mCount{};
+        };
+    }
+
+    /**
+     * Persistent history of transfer totals of server or torrent
+     * Stored in two memory mapped files: per-minute records for a week,
+     * and hourly rollups for 90 days. Each record holds totals at the end of its interval,
+     * so transferred bytes over a range are a difference between two records
+     *
+     * Throws QFileError if files can't be created or mapped
+     */
+    class TransferStatsStore {
+    public:
+        enum class Resolution { Minute, Hour };
+
+        static constexpr int intervalSecs(Resolution resolution) {
+            switch (resolution) {
+            case Resolution::Minute:
+                return 60;
+            case Resolution::Hour:
+                return 3600;
+            }
+            return 60;
+        }
+
+        // 7 days and 90 days
+        static constexpr uint32_t capacity(Resolution resolution) {
+            switch (resolution) {
+            case Resolution::Minute:
+                return 7 * 24 * 60;
+            case Resolution::Hour:
+                return 90 * 24;
+            }
+            return 0;
+        }
+
+        /**
+         * Opens or creates "<basePath>.minutes" and "<basePath>.hours"
+         * Files with unexpected header are recreated
+         */
+        explicit TransferStatsStore(const QString& basePath);
+        ~TransferStatsStore();
+        Q_DISABLE_COPY_MOVE(TransferStatsStore)
+
+        /**
+         * Totals must be appended in chronological order. Totals older than last record are ignored
+         * Intervals may have no record if store wasn't open then (e.g. when totals didn't change)
+         */
+        void append(qint64 timeSecs, qint64 downloaded, qint64 uploaded);
+
+        [[nodiscard]] std::vector<TransferStatsRecord>
+        range(Resolution resolution, qint64 fromSecs, qint64 toSecs) const;
+        [[nodiscard]] size_t size(Resolution resolution) const;
+
+    private:
+        std::array<std::unique_ptr<impl::TimeSeriesFile>, 2> mFiles{};
+    };
+}
+
+#endif // LIBTREMOTESF_TRANSFERSTATSSTORE_H
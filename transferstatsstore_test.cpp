@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2015-2023 Alexey Rochev
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <array>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+#include "literals.h"
+#include "transferstatsstore.h"
+
+using namespace libtremotesf;
+
+class TransferStatsStoreTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void rollsUpIntervals() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        TransferStatsStore store(dir.filePath("server"_l1));
+        store.append(3600, 100, 10);
+        store.append(3630, 200, 20);
+        store.append(3660, 300, 30);
+        store.append(7200, 400, 40);
+
+        const auto minutes = store.range(TransferStatsStore::Resolution::Minute, 0, 10000);
+        QVERIFY(minutes.size() == 3);
+        QVERIFY(minutes[0] == (TransferStatsRecord{.timeSecs = 3600, .downloaded = 200, .uploaded = 20}));
+        QVERIFY(minutes[1] == (TransferStatsRecord{.timeSecs = 3660, .downloaded = 300, .uploaded = 30}));
+        QVERIFY(minutes[2] == (TransferStatsRecord{.timeSecs = 7200, .downloaded = 400, .uploaded = 40}));
+
+        const auto hours = store.range(TransferStatsStore::Resolution::Hour, 0, 10000);
+        QVERIFY(hours.size() == 2);
+        QVERIFY(hours[0] == (TransferStatsRecord{.timeSecs = 3600, .downloaded = 300, .uploaded = 30}));
+        QVERIFY(hours[1] == (TransferStatsRecord{.timeSecs = 7200, .downloaded = 400, .uploaded = 40}));
+    }
+
+    void rangeIsInclusive() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        TransferStatsStore store(dir.filePath("server"_l1));
+        for (qint64 i = 0; i < 10; ++i) {
+            store.append(i * 60, i, i);
+        }
+        const auto records = store.range(TransferStatsStore::Resolution::Minute, 120, 300);
+        QVERIFY(records.size() == 4);
+        QCOMPARE(records.front().timeSecs, qint64{120});
+        QCOMPARE(records.back().timeSecs, qint64{300});
+        QVERIFY(store.range(TransferStatsStore::Resolution::Minute, 1000, 2000).empty());
+    }
+
+    void oldTotalsAreIgnored() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        TransferStatsStore store(dir.filePath("server"_l1));
+        store.append(600, 1, 1);
+        store.append(300, 100, 100);
+        QVERIFY(store.size(TransferStatsStore::Resolution::Minute) == 1);
+        QCOMPARE(store.range(TransferStatsStore::Resolution::Minute, 0, 1000).front().downloaded, qint64{1});
+    }
+
+    void persistsAcrossReopening() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("server"_l1);
+        {
+            TransferStatsStore store(path);
+            store.append(60, 1, 2);
+            store.append(120, 3, 4);
+        }
+        TransferStatsStore store(path);
+        QVERIFY(store.size(TransferStatsStore::Resolution::Minute) == 2);
+        store.append(180, 5, 6);
+        const auto minutes = store.range(TransferStatsStore::Resolution::Minute, 0, 1000);
+        QVERIFY(minutes.size() == 3);
+        QVERIFY(minutes[1] == (TransferStatsRecord{.timeSecs = 120, .downloaded = 3, .uploaded = 4}));
+    }
+
+    void ringIsBounded() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("series"_l1);
+        constexpr uint32_t capacity = 16;
+        {
+            impl::TimeSeriesFile file(path, capacity);
+            for (qint64 i = 0; i < 40; ++i) {
+                file.append({.timeSecs = i, .downloaded = i, .uploaded = i});
+            }
+            QVERIFY(file.size() == capacity);
+            QCOMPARE(file.at(0).timeSecs, 40 - static_cast<qint64>(capacity));
+        }
+        const auto fileSize = QFile(path).size();
+        impl::TimeSeriesFile file(path, capacity);
+        QVERIFY(file.size() == capacity);
+        QCOMPARE(QFile(path).size(), fileSize);
+        const auto records = file.range(30, 35);
+        QVERIFY(records.size() == 6);
+        QCOMPARE(records.front().timeSecs, qint64{30});
+    }
+
+    void tornWriteIsRepaired() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("series"_l1);
+        constexpr uint32_t capacity = 4;
+        {
+            impl::TimeSeriesFile file(path, capacity);
+            for (qint64 i = 0; i < capacity; ++i) {
+                file.append({.timeSecs = i, .downloaded = i, .uploaded = i});
+            }
+        }
+        {
+            // Newest record overwrote the oldest one, but header wasn't updated
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            QVERIFY(file.seek(static_cast<qint64>(sizeof(impl::transferstats::FileHeader))));
+            std::array<char, sizeof(qint64)> time{};
+            qToLittleEndian(qint64{10}, time.data());
+            QCOMPARE(file.write(time.data(), static_cast<qint64>(time.size())), static_cast<qint64>(time.size()));
+        }
+        impl::TimeSeriesFile file(path, capacity);
+        QVERIFY(file.size() == capacity);
+        QCOMPARE(file.at(0).timeSecs, qint64{1});
+        QCOMPARE(file.at(capacity - 1).timeSecs, qint64{10});
+    }
+
+    void outOfOrderRecordsAreDropped() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("series"_l1);
+        {
+            impl::TimeSeriesFile file(path, 16);
+            for (qint64 i = 0; i < 5; ++i) {
+                file.append({.timeSecs = i, .downloaded = i, .uploaded = i});
+            }
+        }
+        {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            const auto fourthRecord = sizeof(impl::transferstats::FileHeader) + 3 * impl::transferstats::recordSize;
+            QVERIFY(file.seek(static_cast<qint64>(fourthRecord)));
+            QCOMPARE(file.write(QByteArray(sizeof(qint64), '\0')), static_cast<qint64>(sizeof(qint64)));
+        }
+        impl::TimeSeriesFile file(path, 16);
+        QVERIFY(file.size() == 3);
+    }
+
+    void invalidFileIsRecreated() {
+        QTemporaryDir dir{};
+        QVERIFY(dir.isValid());
+        const auto path = dir.filePath("series"_l1);
+        {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("garbage");
+        }
+        impl::TimeSeriesFile file(path, 16);
+        QVERIFY(file.size() == 0);
+        file.append({.timeSecs = 1, .downloaded = 2, .uploaded = 3});
+        QVERIFY(file.at(0) == (TransferStatsRecord{.timeSecs = 1, .downloaded = 2, .uploaded = 3}));
+    }
+};
+
+QTEST_MAIN(TransferStatsStoreTest)
+
+#include "transferstatsstore_test.moc"